@@ -1,5 +1,5 @@
 #include "player.h"
-#include <stdio.h>
+#include "strategy.h"
 
 /* Choose a card to play and return the index of its in the players hand
  * To be used by each player for their strategy
@@ -8,33 +8,22 @@
  * @return index of chosen card
  */
 int choose_card(Game* game) {
+    return alice_choose(game);
+}
 
-    if (game->playerID == game->leadPlayer) {
-        char suitPreference[] = {'S', 'C', 'D', 'H'};
-        for (int i = 0; i < NUM_SUITS; i++) {
-            // find highest suit
-            int cardIndex = find_highest_suit(game, suitPreference[i]);
-            if (cardIndex != INVALID) {
-                return cardIndex;
-            }
-        }
-    }
-
-    // play lowest card in lead suit
-    int cardIndex = find_lowest_suit(game, game->turn[game->leadPlayer].suit);
-    if (cardIndex != -1) {
-        return cardIndex;
-    }
-
-    // remaining choices
+/* alice's choices depend on nothing beyond the hand and lead suit
+ *
+ * @param game - main game struct
+ * @return 0
+ */
+int decision_flags(Game* game) {
+    return 0;
+}
 
-    char suitPreference[] = {'D', 'H', 'S', 'C'};
-    for (int i = 0; i < NUM_SUITS; i++) {
-        // find highest suit
-        int cardIndex = find_highest_suit(game, suitPreference[i]);
-        if (cardIndex != INVALID) {
-            return cardIndex;
-        }
-    }
-    return INVALID; // Should never get here
+/* Identify the strategy, for persisted decision caches
+ *
+ * @return strategy name
+ */
+const char* strategy_id(void) {
+    return "alice";
 }
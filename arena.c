@@ -0,0 +1,53 @@
+#include <stdlib.h>
+
+#include "arena.h"
+
+/* Start an arena with no block yet
+ *
+ * @param arena - arena to initialise
+ */
+void arena_init(Arena* arena) {
+    arena->base = NULL;
+    arena->capacity = 0;
+    arena->used = 0;
+}
+
+/* Empty an arena, making sure it can hold a number of bytes
+ * Only reallocates when the arena has never been this big, so resetting for
+ * a game no larger than an earlier one is constant time
+ * Everything previously allocated from it is invalidated
+ *
+ * @param arena - arena to reset
+ * @param size - total ARENA_SIZE of everything that will be allocated
+ */
+void arena_reset(Arena* arena, size_t size) {
+    if (size > arena->capacity) {
+        // nothing in the old block is live, so there is nothing to copy
+        free(arena->base);
+        arena->base = malloc(size); // aligned for any type
+        arena->capacity = size;
+    }
+    arena->used = 0;
+}
+
+/* Take the next bytes of an arena
+ * The arena must have been reset with room for them
+ *
+ * @param arena - arena to allocate from
+ * @param bytes - number of bytes wanted
+ * @return uninitialised memory aligned to ARENA_ALIGN
+ */
+void* arena_alloc(Arena* arena, size_t bytes) {
+    void* memory = arena->base + arena->used;
+    arena->used += ARENA_SIZE(bytes);
+    return memory;
+}
+
+/* Free an arena's block
+ *
+ * @param arena - arena to free
+ */
+void arena_free(Arena* arena) {
+    free(arena->base);
+    arena_init(arena);
+}
@@ -0,0 +1,50 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_ALIGN 16 // alignment of every allocation, enough for any type
+// Arena space taken by an allocation of a number of bytes
+#define ARENA_SIZE(bytes) (((bytes) + ARENA_ALIGN - 1) \
+        & ~(size_t) (ARENA_ALIGN - 1))
+
+// A single block handed out front to back and only ever emptied as a whole,
+// so everything allocated from it is laid out in allocation order
+typedef struct {
+    char* base;
+    size_t capacity;
+    size_t used;
+} Arena;
+
+/* Start an arena with no block yet
+ *
+ * @param arena - arena to initialise
+ */
+void arena_init(Arena* arena);
+
+/* Empty an arena, making sure it can hold a number of bytes
+ * Only reallocates when the arena has never been this big, so resetting for
+ * a game no larger than an earlier one is constant time
+ * Everything previously allocated from it is invalidated
+ *
+ * @param arena - arena to reset
+ * @param size - total ARENA_SIZE of everything that will be allocated
+ */
+void arena_reset(Arena* arena, size_t size);
+
+/* Take the next bytes of an arena
+ * The arena must have been reset with room for them
+ *
+ * @param arena - arena to allocate from
+ * @param bytes - number of bytes wanted
+ * @return uninitialised memory aligned to ARENA_ALIGN
+ */
+void* arena_alloc(Arena* arena, size_t bytes);
+
+/* Free an arena's block
+ *
+ * @param arena - arena to free
+ */
+void arena_free(Arena* arena);
+
+#endif
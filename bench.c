@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "bench.h"
+
+volatile int benchSink;
+
+/* Get the current time in nanoseconds
+ *
+ * @return CLOCK_MONOTONIC time
+ */
+static uint64_t now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+/* Build a line of one repeated character between a prefix and trailer
+ *
+ * @param prefix - start of the line
+ * @param fill - character to repeat LONG_LINE times
+ * @param trailer - end of the line
+ * @return malloced line
+ */
+char* make_long(const char* prefix, char fill, const char* trailer) {
+    int prefixLength = strlen(prefix);
+    char* text = malloc(prefixLength + LONG_LINE + strlen(trailer) + 1);
+    strcpy(text, prefix);
+    memset(text + prefixLength, fill, LONG_LINE);
+    strcpy(text + prefixLength + LONG_LINE, trailer);
+    return text;
+}
+
+/* Time one case, doubling the number of runs until enough time has passed
+ *
+ * @param test - case to run
+ * @param context - passed to the case's run function
+ * @return average nanoseconds per run
+ */
+static double time_case(BenchCase* test, void* context) {
+    long runs = 0;
+    long batch = 1;
+    uint64_t start = now();
+    uint64_t elapsed;
+    do {
+        for (long i = 0; i < batch; i++) {
+            test->run(context, test->input);
+        }
+        runs += batch;
+        batch *= 2;
+        elapsed = now() - start;
+    } while (elapsed < MIN_NANOSECONDS);
+    return (double) elapsed / runs;
+}
+
+/* Time every case whose name contains filter, printing ns per message,
+ * then free their inputs
+ *
+ * @param cases - cases to run
+ * @param numCases - length of cases
+ * @param context - passed to each case's run function
+ * @param filter - substring to match, or NULL for every case
+ */
+void run_cases(BenchCase* cases, int numCases, void* context,
+        const char* filter) {
+    for (int i = 0; i < numCases; i++) {
+        if (filter == NULL || strstr(cases[i].name, filter) != NULL) {
+            printf("%-28s %10.1f ns/message\n", cases[i].name,
+                    time_case(&cases[i], context));
+            fflush(stdout);
+        }
+        free(cases[i].input);
+    }
+}
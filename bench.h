@@ -0,0 +1,39 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+
+#define MIN_NANOSECONDS 50000000 // time each case for at least this long
+#define LONG_LINE 4096 // length of adversarial long lines
+
+// A single benchmark input and the parser to run on it
+typedef struct {
+    const char* name;
+    void (*run)(void* context, char* input); // parse input once
+    char* input; // malloced
+} BenchCase;
+
+// Keeps results alive so the parsers are not optimised away
+extern volatile int benchSink;
+
+/* Build a line of one repeated character between a prefix and trailer
+ *
+ * @param prefix - start of the line
+ * @param fill - character to repeat LONG_LINE times
+ * @param trailer - end of the line
+ * @return malloced line
+ */
+char* make_long(const char* prefix, char fill, const char* trailer);
+
+/* Time every case whose name contains filter, printing ns per message,
+ * then free their inputs
+ *
+ * @param cases - cases to run
+ * @param numCases - length of cases
+ * @param context - passed to each case's run function
+ * @param filter - substring to match, or NULL for every case
+ */
+void run_cases(BenchCase* cases, int numCases, void* context,
+        const char* filter);
+
+#endif
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "bench.h"
+#include "card.h"
+#include "protocol.h"
+#include "hubgame.h"
+
+#define BENCH_PLAYERS 4
+
+/* Build a deckfile holding every card once
+ *
+ * @param badLast - make the last card invalid
+ * @return malloced deckfile text
+ */
+static char* make_deck(bool badLast) {
+    int numCards = NUM_SUITS * NUM_RANKS;
+    char* text = malloc(MESSAGE_SIZE + numCards * CARD_TEXT_SIZE);
+    int length = sprintf(text, "%d\n", numCards);
+    for (int i = 0; i < numCards; i++) {
+        card_to_text(i, text + length);
+        length += CARD_TEXT_SIZE;
+        text[length - 1] = '\n';
+    }
+    text[length] = '\0';
+    if (badLast) {
+        text[length - 2] = 'g';
+    }
+    return text;
+}
+
+/* Run read_deck once on an in memory deckfile
+ *
+ * @param context - unused
+ * @param input - deckfile text
+ */
+static void run_deck(void* context, char* input) {
+    FILE* file = fmemopen(input, strlen(input), "r");
+    int deckSize = 0;
+    Card* deck = read_deck(file, &deckSize);
+    benchSink = deck != NULL ? deckSize : 0;
+    free(deck);
+    fclose(file);
+}
+
+/* Run get_play once, as player 1 following player 0's lead
+ *
+ * @param context - game with player 1's hand counted
+ * @param input - message from player 1
+ */
+static void run_play(void* context, char* input) {
+    Card card;
+    benchSink = get_play(context, 1, input, &card);
+}
+
+int main(int argc, char** argv) {
+    // player 1 holds every C card and must follow player 0's C lead
+    int deckSize;
+    Card* deck = generate_deck(0, &deckSize);
+    Game game = setup_game(2, deckSize, deck, BENCH_PLAYERS);
+    for (int rank = MIN_RANK; rank <= MAX_RANK; rank++) {
+        game.players[1].cardCounts[make_card(CLUBS, rank)]++;
+        game.players[1].suitCounts[CLUBS]++;
+    }
+    game.round[0] = make_card(CLUBS, MAX_RANK);
+    game.playCount = 1;
+
+    BenchCase cases[] = {
+        {"deck/valid", run_deck, make_deck(false)},
+        {"deck/bad-last-card", run_deck, make_deck(true)},
+        {"deck/long-count", run_deck, make_long("", '9', "\n")},
+        {"deck/long-card", run_deck, make_long("1\nS", 'a', "\n")},
+        {"play/valid", run_play, strdup("PLAYC3")},
+        {"play/not-held", run_play, strdup("PLAYS3")},
+        {"play/not-following", run_play, strdup("PLAYD3")},
+        {"play/garbage", run_play, strdup("PLAYX?")},
+        {"play/long", run_play, make_long("PLAY", 'C', "")}
+    };
+    run_cases(cases, sizeof(cases) / sizeof(cases[0]), &game,
+            argc > 1 ? argv[1] : NULL);
+    free_game(&game);
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "bench.h"
+#include "card.h"
+#include "protocol.h"
+#include "player.h"
+
+#define BENCH_PLAYERS 4
+#define BENCH_HAND 16
+
+/* Build a HAND message of BENCH_HAND cards
+ *
+ * @param badLast - make the last card invalid
+ * @return malloced message, without newline
+ */
+static char* make_hand(bool badLast) {
+    Card cards[BENCH_HAND];
+    for (int i = 0; i < BENCH_HAND; i++) {
+        cards[i] = make_card(i % NUM_SUITS, i % NUM_RANKS);
+    }
+    char* text = malloc(HAND_MESSAGE_SIZE(BENCH_HAND));
+    int length = encode_hand(text, cards, BENCH_HAND);
+    text[length - 1] = '\0';
+    if (badLast) {
+        text[length - 2] = 'G';
+    }
+    return text;
+}
+
+/* Decode and process a HAND message once
+ *
+ * @param context - player's game
+ * @param input - message from the hub
+ */
+static void run_hand(void* context, char* input) {
+    Game* game = context;
+    Message message;
+    game->dealt = false;
+    benchSink = decode_message(input, &message, game->hand, game->handSize)
+            != HAND || process_hand_message(&message, game);
+}
+
+/* Decode and process a NEWROUND message once
+ *
+ * @param context - player's game
+ * @param input - message from the hub
+ */
+static void run_new_round(void* context, char* input) {
+    Game* game = context;
+    Message message;
+    game->playerCount = game->numPlayers; // previous round over
+    benchSink = decode_message(input, &message, game->hand, game->handSize)
+            != NEW_ROUND || process_new_round_message(&message, game);
+}
+
+/* Decode and process a PLAYED message once, from the round's lead player
+ *
+ * @param context - player's game
+ * @param input - message from the hub
+ */
+static void run_played(void* context, char* input) {
+    Game* game = context;
+    Message message;
+    game->leadPlayer = 0;
+    game->playerCount = 0;
+    benchSink = decode_message(input, &message, game->hand, game->handSize)
+            != PLAYED || process_played_message(&message, game);
+}
+
+int main(int argc, char** argv) {
+    Game game = setup_game(BENCH_PLAYERS, 1, 2, BENCH_HAND);
+    game.dealt = true;
+
+    BenchCase cases[] = {
+        {"hand/valid", run_hand, make_hand(false)},
+        {"hand/bad-last-card", run_hand, make_hand(true)},
+        {"hand/long", run_hand, make_long("HAND16", ',', "")},
+        {"newround/valid", run_new_round, strdup("NEWROUND0")},
+        {"newround/out-of-range", run_new_round, strdup("NEWROUND9")},
+        {"newround/long-number", run_new_round,
+                make_long("NEWROUND", '9', "")},
+        {"played/valid", run_played, strdup("PLAYED0,Sa")},
+        {"played/wrong-player", run_played, strdup("PLAYED3,Sa")},
+        {"played/leading-zeros", run_played,
+                make_long("PLAYED", '0', ",Sa")}
+    };
+    run_cases(cases, sizeof(cases) / sizeof(cases[0]), &game,
+            argc > 1 ? argv[1] : NULL);
+    free_game(&game);
+    return 0;
+}
@@ -1,84 +1,54 @@
+#include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 
 #include "player.h"
+#include "strategy.h"
 
-/* Check if any player has reached treshold - 2 D cards
+/* Get bob's parameters: tuned ones from BOB_PARAMS_ENV, otherwise (or if
+ * they are invalid) the defaults
  *
- * @param game - main game struct
- * @return true iff at least one player has reached threshold - 2 D cards
+ * @return parameters to play with
  */
-bool threshold_reached(Game* game) {
-    for (int i = 0; i < game->numPlayers; i++) {
-        if (game->dWon[i] >= game->threshold - 2) {
-            return true;
+static const BobParams* bob_params(void) {
+    static BobParams params;
+    static bool loaded = false;
+    if (!loaded) {
+        char* text = getenv(BOB_PARAMS_ENV);
+        if (text == NULL || parse_bob_params(text, &params)) {
+            params = defaultBobParams;
         }
+        loaded = true;
     }
-    return false;
+    return &params;
 }
 
-/* Check if any player has played a D card this round
+/* Choose a card to play and return the index of its in the players hand
+ * To be used by each player for their strategy
  *
  * @param game - main game struct
- * @return true iff at least one player has played a D card this round
+ * @return index of chosen card
  */
-bool played_d(Game* game) {
-    for (int i = 0; i < game->playerCount; i++) {
-        if (game->turn[(i + game->leadPlayer)
-                % game->numPlayers].suit == 'D') {
-            return true;
-        }
-    }
-    return false;
+int choose_card(Game* game) {
+    return bob_choose(game, bob_params());
 }
 
-/* Choose a card to play and return the index of its in the players hand
- * To be used by each player for their strategy
+/* bob also decides by whether D cards are at stake
  *
  * @param game - main game struct
- * @return index of chosen card
+ * @return 1 if bob is contesting the round, otherwise 0
  */
-int choose_card(Game* game) {
-    if (game->playerID == game->leadPlayer) {
-        char suitPreference[] = {'D', 'H', 'S', 'C'};
-        for (int i = 0; i < NUM_SUITS; i++) {
-            // find lowest card in suit
-            int cardIndex = find_lowest_suit(game, suitPreference[i]);
-            if (cardIndex != -1) {
-                return cardIndex;
-            }
-        }
-    }
+int decision_flags(Game* game) {
+    return bob_contesting(game, bob_params());
+}
 
-    if (threshold_reached(game) && played_d(game)) {
-        // play highest card in lead suit
-        int cardIndex = 
-                find_highest_suit(game, game->turn[game->leadPlayer].suit);
-        if (cardIndex != INVALID) {
-            return cardIndex;
-        }
-        char suitPreference[] = {'S', 'C', 'H', 'D'};
-        for (int i = 0; i < NUM_SUITS; i++) { 
-            // find highest card in suit
-            int cardIndex = find_lowest_suit(game, suitPreference[i]);
-            if (cardIndex != INVALID) {
-                return cardIndex;
-            }
-        }
-    } else {
-        // play lowest card in lead suit
-        int cardIndex =
-                find_lowest_suit(game, game->turn[game->leadPlayer].suit);
-        if (cardIndex != INVALID) {
-            return cardIndex;
-        }
-        char suitPreference[] = {'S', 'C', 'D', 'H'};
-        for (int i = 0; i < NUM_SUITS; i++) {
-            // find highest card in suit
-            int cardIndex = find_highest_suit(game, suitPreference[i]);
-            if (cardIndex != INVALID) {
-                return cardIndex;
-            }
-        }
-    }
-    return -1; // Should never reach here
+/* Identify the strategy and its parameters, for persisted decision caches
+ *
+ * @return strategy name and parameters
+ */
+const char* strategy_id(void) {
+    static char id[BOB_PARAMS_SIZE + sizeof("bob ")];
+    strcpy(id, "bob ");
+    format_bob_params(bob_params(), id + strlen(id));
+    return id;
 }
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <limits.h>
+
+#include "cache.h"
+
+// Header of a saved cache
+typedef struct {
+    char magic[8];
+    char strategy[STRATEGY_ID_SIZE];
+    // rules variant the player was built for, as cards pack differently
+    uint8_t numSuits;
+    uint8_t numRanks;
+    uint8_t penaltySuit;
+    uint8_t padding;
+    uint32_t numEntries;
+} CacheHeader;
+
+// A saved decision
+typedef struct {
+    uint64_t hand;
+    uint8_t lead;
+    uint8_t flags;
+    uint8_t card;
+    uint8_t padding[5];
+} SavedEntry;
+
+/* Find the set a situation belongs in
+ *
+ * @param situation - situation to place
+ * @return set index
+ */
+static int set_of(const Situation* situation) {
+    uint64_t hash = situation->hand ^ ((uint64_t) situation->lead << 56)
+            ^ ((uint64_t) situation->flags << 60);
+    hash *= 0x9e3779b97f4a7c15ULL;
+    return hash >> 32 & (CACHE_SETS - 1);
+}
+
+/* Check whether two situations are the same
+ *
+ * @param a - first situation
+ * @param b - second situation
+ * @return true iff they are equal
+ */
+static bool same_situation(const Situation* a, const Situation* b) {
+    return a->hand == b->hand && a->lead == b->lead && a->flags == b->flags;
+}
+
+/* Create an empty cache, loading saved decisions from a file if one is
+ * given and was saved by the same strategy under the same rules variant
+ *
+ * @param strategy - identifies the strategy and its parameters
+ * @param filename - file saved by cache_save, or NULL
+ * @return new cache
+ */
+DecisionCache* cache_create(const char* strategy, const char* filename) {
+    DecisionCache* cache = calloc(1, sizeof(DecisionCache));
+    strncpy(cache->strategy, strategy, STRATEGY_ID_SIZE - 1);
+    FILE* file = filename != NULL ? fopen(filename, "r") : NULL;
+    if (file == NULL) {
+        return cache;
+    }
+    CacheHeader header;
+    if (fread(&header, sizeof(header), 1, file) == 1
+            && memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) == 0
+            && strncmp(header.strategy, cache->strategy,
+            STRATEGY_ID_SIZE) == 0
+            && header.numSuits == NUM_SUITS && header.numRanks == NUM_RANKS
+            && header.penaltySuit == PENALTY_SUIT) {
+        SavedEntry saved;
+        for (uint32_t i = 0; i < header.numEntries
+                && fread(&saved, sizeof(saved), 1, file) == 1; i++) {
+            Situation situation = {saved.hand, saved.lead, saved.flags};
+            if (card_valid(saved.card)
+                    && (saved.hand >> saved.card & 1)) {
+                cache_insert(cache, &situation, saved.card);
+            }
+        }
+    }
+    fclose(file);
+    return cache;
+}
+
+/* Look up the card chosen in a situation
+ *
+ * @param cache - the cache
+ * @param situation - situation to look up
+ * @param card - where to store the card chosen
+ * @return true on a miss
+ */
+bool cache_lookup(DecisionCache* cache, const Situation* situation,
+        Card* card) {
+    CacheEntry* set = cache->entries[set_of(situation)];
+    for (int i = 0; i < CACHE_WAYS; i++) {
+        if (set[i].used && same_situation(&set[i].situation, situation)) {
+            set[i].referenced = true;
+            *card = set[i].card;
+            cache->hits++;
+            return false;
+        }
+    }
+    cache->misses++;
+    return true;
+}
+
+/* Remember the card chosen in a situation, evicting an older decision if
+ * its set is full
+ *
+ * @param cache - the cache
+ * @param situation - situation decided
+ * @param card - card chosen
+ */
+void cache_insert(DecisionCache* cache, const Situation* situation,
+        Card card) {
+    int index = set_of(situation);
+    CacheEntry* set = cache->entries[index];
+    // the clock hand skips (and clears) entries hit since it last passed
+    int way = cache->hands[index];
+    while (set[way].used && set[way].referenced) {
+        set[way].referenced = false;
+        way = (way + 1) % CACHE_WAYS;
+    }
+    cache->hands[index] = (way + 1) % CACHE_WAYS;
+    set[way].situation = *situation;
+    set[way].card = card;
+    set[way].used = true;
+    set[way].referenced = false;
+}
+
+/* Save every decision held to a file, replacing it atomically so that
+ * concurrent players never see a partial file
+ *
+ * @param cache - the cache
+ * @param filename - file to write
+ * @return true if the file could not be written
+ */
+bool cache_save(DecisionCache* cache, const char* filename) {
+    char temporary[PATH_MAX];
+    snprintf(temporary, sizeof(temporary), "%s.%d", filename, getpid());
+    FILE* file = fopen(temporary, "w");
+    if (file == NULL) {
+        return true;
+    }
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    memcpy(header.strategy, cache->strategy, STRATEGY_ID_SIZE);
+    header.numSuits = NUM_SUITS;
+    header.numRanks = NUM_RANKS;
+    header.penaltySuit = PENALTY_SUIT;
+    for (int i = 0; i < CACHE_SETS; i++) {
+        for (int j = 0; j < CACHE_WAYS; j++) {
+            header.numEntries += cache->entries[i][j].used;
+        }
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    for (int i = 0; i < CACHE_SETS; i++) {
+        for (int j = 0; j < CACHE_WAYS; j++) {
+            CacheEntry* entry = &cache->entries[i][j];
+            if (entry->used) {
+                SavedEntry saved;
+                memset(&saved, 0, sizeof(saved));
+                saved.hand = entry->situation.hand;
+                saved.lead = entry->situation.lead;
+                saved.flags = entry->situation.flags;
+                saved.card = entry->card;
+                fwrite(&saved, sizeof(saved), 1, file);
+            }
+        }
+    }
+    if (fclose(file) || rename(temporary, filename)) {
+        unlink(temporary);
+        return true;
+    }
+    return false;
+}
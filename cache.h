@@ -0,0 +1,83 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "card.h"
+
+#define CACHE_ENV "DECISION_CACHE_2310" // enables the cache; a non empty
+                                        // value is where to persist it
+#define CACHE_WAYS 4 // entries per set
+#define CACHE_SETS 1024 // must be power of 2
+#define CACHE_MAGIC "2310DC02"
+#define STRATEGY_ID_SIZE 64
+#define LEADING 0xf // lead suit of a situation where this player leads
+
+// Everything a decision depends on
+typedef struct {
+    uint64_t hand; // bit per card still held (copies do not change choices)
+    uint8_t lead; // suit led, or LEADING
+    uint8_t flags; // strategy specific, from decision_flags
+} Situation;
+
+// A Situation's hand has one bit per card, so no rules variant may have a
+// deck of more than 64 distinct cards
+typedef char CacheDeckFits[FULL_DECK <= 64 ? 1 : -1];
+
+// A remembered decision
+typedef struct {
+    Situation situation;
+    Card card; // card chosen
+    bool used; // holds a decision
+    bool referenced; // hit since the clock hand last passed
+} CacheEntry;
+
+// Set associative cache of decisions, with CLOCK eviction inside each set
+typedef struct {
+    CacheEntry entries[CACHE_SETS][CACHE_WAYS];
+    uint8_t hands[CACHE_SETS]; // clock hand of each set
+    char strategy[STRATEGY_ID_SIZE]; // strategy whose decisions are held
+    long hits;
+    long misses;
+} DecisionCache;
+
+/* Create an empty cache, loading saved decisions from a file if one is
+ * given and was saved by the same strategy under the same rules variant
+ *
+ * @param strategy - identifies the strategy and its parameters
+ * @param filename - file saved by cache_save, or NULL
+ * @return new cache
+ */
+DecisionCache* cache_create(const char* strategy, const char* filename);
+
+/* Look up the card chosen in a situation
+ *
+ * @param cache - the cache
+ * @param situation - situation to look up
+ * @param card - where to store the card chosen
+ * @return true on a miss
+ */
+bool cache_lookup(DecisionCache* cache, const Situation* situation,
+        Card* card);
+
+/* Remember the card chosen in a situation, evicting an older decision if
+ * its set is full
+ *
+ * @param cache - the cache
+ * @param situation - situation decided
+ * @param card - card chosen
+ */
+void cache_insert(DecisionCache* cache, const Situation* situation,
+        Card card);
+
+/* Save every decision held to a file, replacing it atomically so that
+ * concurrent players never see a partial file
+ *
+ * @param cache - the cache
+ * @param filename - file to write
+ * @return true if the file could not be written
+ */
+bool cache_save(DecisionCache* cache, const char* filename);
+
+#endif
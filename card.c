@@ -0,0 +1,106 @@
+#include <stdbool.h>
+
+#include "card.h"
+
+/* Find which card wins a round: the highest card in the suit led
+ *
+ * @param round - cards played, in order starting with the lead card
+ * @param numCards - number of cards played
+ * @return index into round of the winning card
+ */
+int round_winner(const Card* round, int numCards) {
+    Suit leadSuit = card_suit(round[0]);
+    int maxRank = card_rank(round[0]);
+    int winner = 0;
+    for (int i = 1; i < numCards; i++) {
+        if (card_suit(round[i]) == leadSuit) {
+            if (card_rank(round[i]) > maxRank) {
+                winner = i;
+                maxRank = card_rank(round[i]);
+            }
+        }
+    }
+    return winner;
+}
+
+/* Convert a suit character to a suit
+ *
+ * @param c - character to convert
+ * @return matching suit or -1 if c is not a suit character
+ */
+int parse_suit(char c) {
+#define SUIT_CASE(suit, character) case character: return suit;
+    switch (c) {
+        SUITS(SUIT_CASE)
+        default:
+            return -1;
+    }
+#undef SUIT_CASE
+}
+
+/* Convert the two character text form of a card (eg "Da") to a card
+ * The rank must be a single lower case hex digit no more than MAX_RANK
+ *
+ * @param text - text to convert, need not be null terminated
+ * @param card - pointer to store card in
+ * @return false if the text was a valid card, true otherwise
+ */
+bool parse_card(const char* text, Card* card) {
+    int suit = parse_suit(text[0]);
+    if (suit == -1) {
+        return true;
+    }
+    int rank;
+    if (text[1] >= '0' && text[1] <= '9') {
+        rank = text[1] - '0';
+    } else if (text[1] >= 'a' && text[1] <= 'f') {
+        rank = text[1] - 'a' + 10;
+    } else {
+        return true;
+    }
+#if NUM_RANKS < 16
+    if (rank > MAX_RANK) {
+        return true;
+    }
+#endif
+    *card = make_card(suit, rank);
+    return false;
+}
+
+/* Write the text form of a card (eg "Da") into a buffer
+ *
+ * @param card - card to convert
+ * @param buffer - buffer of at least CARD_TEXT_SIZE chars
+ * @return buffer
+ */
+char* card_to_text(Card card, char* buffer) {
+    buffer[0] = suit_char(card_suit(card));
+    buffer[1] = "0123456789abcdef"[card_rank(card)];
+    buffer[2] = '\0';
+    return buffer;
+}
+
+/* Shuffle a deck holding every card exactly once
+ * The same seed always produces the same deck
+ *
+ * @param seed - seed for the shuffle
+ * @param deck - array of FULL_DECK cards to fill
+ */
+void shuffle_deck(unsigned long seed, Card* deck) {
+    for (int i = 0; i < FULL_DECK; i++) {
+        deck[i] = i;
+    }
+
+    // Fisher-Yates shuffle driven by xorshift64*, so decks do not depend on
+    // the C library's rand()
+    unsigned long long state = seed * 0x9e3779b97f4a7c15ULL + 1;
+    for (int i = FULL_DECK - 1; i > 0; i--) {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        int j = (state * 0x2545f4914f6cdd1dULL) % (i + 1);
+        Card swap = deck[i];
+        deck[i] = deck[j];
+        deck[j] = swap;
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef CARD_H
+#define CARD_H
+
+#include <stdbool.h>
+
+#include "rules.h"
+
+#define MIN_RANK 0x0 // lowest rank card
+#define MAX_RANK (NUM_RANKS - 1) // Highest rank card
+#define NO_CARD 0xff // marks a played card or an empty slot
+#define CARD_TEXT_SIZE 3 // suit, rank and null terminator
+#define FULL_DECK (NUM_SUITS * NUM_RANKS) // every card once
+
+#define SUIT_ENUM(suit, character) suit,
+#define SUIT_CHAR(suit, character) character,
+
+// Suits, in the order they are packed into a card, then the number of suits
+typedef enum {
+    SUITS(SUIT_ENUM)
+    NUM_SUITS
+} Suit;
+
+// A card packed into a single byte as suit * NUM_RANKS + rank
+// NO_CARD's suit is outside the valid range, so it never matches a real suit
+typedef unsigned char Card;
+
+/* Pack a suit and rank into a card
+ *
+ * @param suit - suit of card
+ * @param rank - rank of card, between MIN_RANK and MAX_RANK
+ * @return packed card
+ */
+static inline Card make_card(Suit suit, int rank) {
+    return suit * NUM_RANKS + rank;
+}
+
+/* Get the suit of a card
+ *
+ * @param card - packed card
+ * @return suit of card (not a valid suit for NO_CARD)
+ */
+static inline Suit card_suit(Card card) {
+    return card / NUM_RANKS;
+}
+
+/* Get the rank of a card
+ *
+ * @param card - packed card
+ * @return rank of card
+ */
+static inline int card_rank(Card card) {
+    return card % NUM_RANKS;
+}
+
+/* Check whether a card slot holds a real card
+ *
+ * @param card - packed card
+ * @return true iff card is not NO_CARD
+ */
+static inline bool card_valid(Card card) {
+    return card < NUM_SUITS * NUM_RANKS;
+}
+
+/* Get the character representing a suit
+ *
+ * @param suit - suit to convert
+ * @return the suit's character from SUITS
+ */
+static inline char suit_char(Suit suit) {
+    static const char characters[NUM_SUITS] = {SUITS(SUIT_CHAR)};
+    return characters[suit];
+}
+
+/* Find which card wins a round: the highest card in the suit led
+ *
+ * @param round - cards played, in order starting with the lead card
+ * @param numCards - number of cards played
+ * @return index into round of the winning card
+ */
+int round_winner(const Card* round, int numCards);
+
+/* Convert a suit character to a suit
+ *
+ * @param c - character to convert
+ * @return matching suit or -1 if c is not a suit character
+ */
+int parse_suit(char c);
+
+/* Convert the two character text form of a card (eg "Da") to a card
+ * The rank must be a single lower case hex digit
+ *
+ * @param text - text to convert, need not be null terminated
+ * @param card - pointer to store card in
+ * @return false if the text was a valid card, true otherwise
+ */
+bool parse_card(const char* text, Card* card);
+
+/* Write the text form of a card (eg "Da") into a buffer
+ *
+ * @param card - card to convert
+ * @param buffer - buffer of at least CARD_TEXT_SIZE chars
+ * @return buffer
+ */
+char* card_to_text(Card card, char* buffer);
+
+/* Shuffle a deck holding every card exactly once
+ * The same seed always produces the same deck
+ *
+ * @param seed - seed for the shuffle
+ * @param deck - array of FULL_DECK cards to fill
+ */
+void shuffle_deck(unsigned long seed, Card* deck);
+
+#endif
@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+#include "../hubgame.h"
+
+/* Parse the input as a deckfile
+ *
+ * @param data - deckfile bytes
+ * @param size - number of bytes
+ * @return 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // fmemopen rejects empty buffers, so always hand it at least one byte
+    char* text = malloc(size + 1);
+    memcpy(text, data, size);
+    text[size] = '\0';
+    FILE* file = fmemopen(text, size ? size : 1, "r");
+    int deckSize;
+    Card* deck = read_deck(file, &deckSize);
+    if (deck != NULL) {
+        for (int i = 0; i < deckSize; i++) {
+            if (!card_valid(deck[i])) {
+                abort();
+            }
+        }
+    } else if (getenv(FUZZ_ACCEPT_ENV) != NULL) {
+        abort(); // a seed that should be a valid deck
+    }
+    free(deck);
+    fclose(file);
+    free(text);
+    return 0;
+}
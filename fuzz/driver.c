@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sanitizer/common_interface_defs.h>
+
+#include "fuzz.h"
+
+#define DEFAULT_RUNS 100000
+#define MAX_FUZZ_INPUT 4096
+#define MAX_MUTATIONS 8
+#define CRASH_FILE "crash-input"
+#define MAX_CORPUS 4096
+
+// Standalone replacement for libFuzzer's main, for toolchains without it
+// Runs every corpus input, then random mutations of them
+
+// Inputs read from the corpus
+static uint8_t* corpus[MAX_CORPUS];
+static size_t corpusSizes[MAX_CORPUS];
+static int corpusCount;
+
+// Input currently being run, written out if it crashes
+static uint8_t current[MAX_FUZZ_INPUT];
+static size_t currentSize;
+
+// Bytes likely to reach new parser states
+static const char* tokens[] = {"\n", ",", "HAND", "NEWROUND", "PLAYED",
+        "GAMEOVER", "PLAY", "99999999999", "0", "-1", "S", "Da", "Hf", "C0"};
+
+/* Save the input being run, called by the sanitizers before they exit
+ */
+static void save_crash(void) {
+    FILE* file = fopen(CRASH_FILE, "w");
+    if (file != NULL) {
+        fwrite(current, 1, currentSize, file);
+        fclose(file);
+        fprintf(stderr, "Input written to %s\n", CRASH_FILE);
+    }
+}
+
+/* Add a file to the corpus
+ *
+ * @param path - file to read
+ */
+static void add_file(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL || corpusCount == MAX_CORPUS) {
+        if (file != NULL) {
+            fclose(file);
+        }
+        return;
+    }
+    uint8_t* data = malloc(MAX_FUZZ_INPUT);
+    corpusSizes[corpusCount] = fread(data, 1, MAX_FUZZ_INPUT, file);
+    corpus[corpusCount++] = data;
+    fclose(file);
+}
+
+/* Add a file, or every file in a directory, to the corpus
+ *
+ * @param path - file or directory
+ */
+static void add_path(const char* path) {
+    DIR* directory = opendir(path);
+    if (directory == NULL) {
+        add_file(path);
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        char child[PATH_MAX];
+        snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+        add_file(child);
+    }
+    closedir(directory);
+}
+
+/* Run the target on a copy of some bytes, so overreads are caught
+ *
+ * @param data - input
+ * @param size - length of input
+ */
+static void run_one(const uint8_t* data, size_t size) {
+    memcpy(current, data, size);
+    currentSize = size;
+    uint8_t* copy = malloc(size ? size : 1);
+    memcpy(copy, data, size);
+    LLVMFuzzerTestOneInput(copy, size);
+    free(copy);
+}
+
+/* Apply one random change to the current input
+ */
+static void mutate(void) {
+    size_t position = currentSize ? rand() % currentSize : 0;
+    switch (rand() % 5) {
+        case 0: // flip a bit
+            if (currentSize) {
+                current[position] ^= 1 << (rand() % 8);
+            }
+            break;
+        case 1: // replace a byte
+            if (currentSize) {
+                current[position] = rand();
+            }
+            break;
+        case 2: // delete a run of bytes
+            if (currentSize) {
+                size_t length = 1 + rand() % (currentSize - position);
+                memmove(current + position, current + position + length,
+                        currentSize - position - length);
+                currentSize -= length;
+            }
+            break;
+        case 3: { // insert a token
+            const char* token = tokens[rand() % (sizeof(tokens)
+                    / sizeof(tokens[0]))];
+            size_t length = strlen(token);
+            if (currentSize + length <= MAX_FUZZ_INPUT) {
+                memmove(current + position + length, current + position,
+                        currentSize - position);
+                memcpy(current + position, token, length);
+                currentSize += length;
+            }
+            break;
+        }
+        default: { // splice in part of another input
+            int other = rand() % corpusCount;
+            size_t length = corpusSizes[other] ? rand() % corpusSizes[other]
+                    : 0;
+            if (currentSize + length <= MAX_FUZZ_INPUT) {
+                memmove(current + position + length, current + position,
+                        currentSize - position);
+                memcpy(current + position, corpus[other], length);
+                currentSize += length;
+            }
+            break;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    long runs = DEFAULT_RUNS;
+    unsigned int seed = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        if (opt == 'n') {
+            runs = strtol(optarg, NULL, 10);
+        } else if (opt == 's') {
+            seed = strtoul(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [-n runs] [-s seed] corpus {corpus}\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    __sanitizer_set_death_callback(save_crash);
+    srand(seed);
+    for (int i = optind; i < argc; i++) {
+        add_path(argv[i]);
+    }
+    for (int i = 0; i < corpusCount; i++) {
+        run_one(corpus[i], corpusSizes[i]);
+    }
+    if (corpusCount == 0) {
+        corpus[corpusCount] = calloc(1, 1);
+        corpusSizes[corpusCount++] = 0;
+    }
+
+    for (long i = 0; i < runs; i++) {
+        int base = rand() % corpusCount;
+        memcpy(current, corpus[base], corpusSizes[base]);
+        currentSize = corpusSizes[base];
+        int mutations = 1 + rand() % MAX_MUTATIONS;
+        for (int j = 0; j < mutations; j++) {
+            mutate();
+        }
+        uint8_t input[MAX_FUZZ_INPUT];
+        memcpy(input, current, currentSize);
+        run_one(input, currentSize);
+    }
+    printf("%d corpus inputs and %ld mutations ran cleanly (seed %u)\n",
+            corpusCount, runs, seed);
+    for (int i = 0; i < corpusCount; i++) {
+        free(corpus[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef FUZZ_H
+#define FUZZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// When set, inputs the function under test rejects abort like a crash, so
+// seeds meant to get past the parsers can be checked with -n 0
+#define FUZZ_ACCEPT_ENV "FUZZ_ACCEPT"
+
+/* Run the function under test on one input, libFuzzer style
+ * Crashes and sanitizer reports are the only failures
+ *
+ * @param data - input bytes, not null terminated
+ * @param size - number of bytes
+ * @return 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+#endif
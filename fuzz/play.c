@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+#include "../hubgame.h"
+
+#define FUZZ_PLAYERS 4
+#define HEADER_SIZE 2 // bytes choosing the deal and the lead card
+
+/* Check the input as a PLAY message from player 1, who is following
+ * player 0's lead from a dealt hand
+ *
+ * @param data - first byte seeds the deal, second picks the lead card,
+ * the rest is the message
+ * @param size - number of bytes
+ * @return 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < HEADER_SIZE) {
+        return 0;
+    }
+    int deckSize;
+    Card* deck = generate_deck(data[0], &deckSize);
+    Game game = setup_game(2, deckSize, deck, FUZZ_PLAYERS);
+    for (int i = 0; i < game.numPlayers; i++) {
+        Card* hand = game.deck + i * game.handSize;
+        for (int j = 0; j < game.handSize; j++) {
+            game.players[i].cardCounts[hand[j]]++;
+            game.players[i].suitCounts[card_suit(hand[j])]++;
+        }
+    }
+    game.round[0] = data[1] % deckSize;
+    game.playCount = 1;
+
+    char* message = malloc(size - HEADER_SIZE + 1);
+    memcpy(message, data + HEADER_SIZE, size - HEADER_SIZE);
+    message[size - HEADER_SIZE] = '\0';
+    Card card;
+    enum ExitStatus status = get_play(&game, 1, message, &card);
+    if (status == NORMAL && game.players[1].cardCounts[card] == 0) {
+        abort(); // accepted a card the player does not hold
+    }
+    if (status != NORMAL && getenv(FUZZ_ACCEPT_ENV) != NULL) {
+        abort(); // a seed that should be a valid play
+    }
+    free(message);
+    free_game(&game);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "fuzz.h"
+#include "../player.h"
+
+#define HEADER_SIZE 3 // bytes choosing players, position and hand size
+#define MAX_FUZZ_PLAYERS 6
+#define MAX_FUZZ_HAND 20
+
+/* Feed the input to a player, one line per message
+ *
+ * @param data - first bytes pick the player's arguments, the rest is the
+ * hub's side of the conversation
+ * @param size - number of bytes
+ * @return 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static FILE* devNull;
+    if (devNull == NULL) {
+        devNull = fopen("/dev/null", "w");
+    }
+    if (size < HEADER_SIZE) {
+        return 0;
+    }
+    int numPlayers = 2 + data[0] % (MAX_FUZZ_PLAYERS - 1);
+    int playerID = data[1] % numPlayers;
+    int handSize = 1 + data[2] % MAX_FUZZ_HAND;
+    Game game = setup_game(numPlayers, playerID, 2, handSize);
+    game.output = devNull;
+
+    char* text = malloc(size - HEADER_SIZE + 1);
+    memcpy(text, data + HEADER_SIZE, size - HEADER_SIZE);
+    text[size - HEADER_SIZE] = '\0';
+    bool gameOver = false;
+    char* save;
+    for (char* line = strtok_r(text, "\n", &save); line != NULL && !gameOver;
+            line = strtok_r(NULL, "\n", &save)) {
+        if (process_message(&game, line, &gameOver) != NORMAL) {
+            break;
+        }
+    }
+    if (!gameOver && getenv(FUZZ_ACCEPT_ENV) != NULL) {
+        abort(); // a seed that should play a whole game
+    }
+    free(text);
+    free_game(&game);
+    return 0;
+}
@@ -0,0 +1,1199 @@
+#define _GNU_SOURCE // fopencookie
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "hubgame.h"
+#include "protocol.h"
+
+#define DEFAULT_MAX_GAMES 16
+#define DEFAULT_MAX_QUEUED 64
+#define MAX_REQUEST 4096 // longest request line accepted
+#define MAX_LINE 4096 // longest player message accepted
+#define READ_SIZE 512
+#define SEED_PREFIX "seed="
+#define POOL_ENV "PLAYER_POOL_2310" // shared processes per player executable
+
+// Set by the SIGTERM and SIGINT handler to shut the daemon down, which
+// also writes to the wakeup pipe so a poll in progress returns
+static volatile sig_atomic_t stopping;
+static int wakeup[2];
+
+// Enum for all daemon exit statuses
+enum DaemonStatus {
+    DAEMON_NORMAL = 0,
+    DAEMON_USAGE = 1,
+    DAEMON_SOCKET = 2
+};
+
+// Where a connection is in its lifetime
+enum TableState {
+    READING_REQUEST,
+    QUEUED,
+    STARTING,
+    PLAYING,
+    FLUSHING
+};
+
+// Partial input read from a player
+typedef struct {
+    char data[MAX_LINE];
+    int length;
+} Inbox;
+
+// Output queued for a player, written as its pipe has room
+typedef struct {
+    int fd; // non-blocking write end of the pipe, or -1
+    char* data;
+    size_t length;
+    size_t capacity;
+} Outbox;
+
+// One client connection and the game it requested
+typedef struct {
+    int client;
+    enum TableState state;
+    unsigned long arrival; // used to admit queued games in order
+    char request[MAX_REQUEST];
+    int requestLength;
+    char* args[MAX_REQUEST / 2 + 1]; // request split into hub style argv
+    int numArgs;
+    bool hasGame;
+    Game game;
+    Inbox* inboxes;
+    Outbox* outboxes; // output queued for each seat's own process
+    struct Channel** channels; // shared process serving each seat, or NULL
+    int ready; // number of players that have sent '@'
+    FILE* output;
+    char* outputData;
+    size_t outputSize;
+    size_t outputSent;
+} Table;
+
+// What a game id on a shared player process is being used for
+typedef struct {
+    Table* table; // table the id is serving, or NULL
+    int seat;
+    bool closing; // the table is done with it, waiting for the player's END
+} Slot;
+
+// A shared player process serving seats from many tables, each under its
+// own game id
+typedef struct Channel {
+    char* executable;
+    pid_t pid;
+    FILE* write; // queues into outbox, shared by every seat it serves
+    Outbox outbox;
+    int read;
+    Inbox inbox;
+    Slot* slots; // indexed by game id
+    int numSlots;
+    int load; // ids in use, including closing ones
+    bool dead; // the process has gone, so the channel is to be removed
+} Channel;
+
+// What a polled descriptor belongs to (whether it is polled for reading or
+// writing is in its events)
+typedef struct {
+    Table* table; // table it belongs to, or NULL
+    Channel* channel; // shared process it belongs to, or NULL
+    int seat; // table seat whose queued output it takes, or INVALID
+} Watch;
+
+// Daemon wide state
+typedef struct {
+    int listener;
+    char* path; // socket file, removed on shutdown
+    int maxGames;
+    int maxQueued;
+    Table** tables;
+    int numTables;
+    int activeGames;
+    unsigned long arrivals;
+    SpectateRing* spectators; // shared by every game, or NULL
+    Metrics* metrics; // shared by every game, or NULL
+    int poolSize; // shared processes per player executable, 0 for none
+    Channel** channels;
+    int numChannels;
+} Daemon;
+
+/* Exit the daemon after printing the correct error message
+ *
+ * @param status - the exit status to use
+ */
+void quit_daemon(enum DaemonStatus status) {
+    if (status == DAEMON_USAGE) {
+        fprintf(stderr, "Usage: 2310hubd socket [maxgames [maxqueued]]\n");
+    } else if (status == DAEMON_SOCKET) {
+        fprintf(stderr, "Socket error\n");
+    }
+    exit(status);
+}
+
+/* Create the listening unix socket, replacing any stale socket file
+ *
+ * @param path - filesystem path to bind to
+ * @return listening socket or -1 on error
+ */
+int open_listener(char* path) {
+    struct sockaddr_un address;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr*) &address, sizeof(address)) ||
+            listen(fd, SOMAXCONN)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Send as much pending game output to the client as it will take without
+ * blocking
+ *
+ * @param table - table to flush
+ * @return false if the client has gone away, true otherwise
+ */
+bool flush_output(Table* table) {
+    fflush(table->output);
+    while (table->outputSent < table->outputSize) {
+        ssize_t sent = send(table->client,
+                table->outputData + table->outputSent,
+                table->outputSize - table->outputSent,
+                MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent == -1) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        table->outputSent += sent;
+    }
+    return true;
+}
+
+/* Queue bytes written to a player's stream, for fopencookie
+ *
+ * @param cookie - outbox the stream was opened on
+ * @param buffer - bytes written
+ * @param size - number of bytes written
+ * @return number of bytes queued, which is all of them
+ */
+ssize_t queue_output(void* cookie, const char* buffer, size_t size) {
+    Outbox* outbox = cookie;
+    if (outbox->length + size > outbox->capacity) {
+        outbox->capacity = 2 * (outbox->length + size);
+        outbox->data = realloc(outbox->data, outbox->capacity);
+    }
+    memcpy(outbox->data + outbox->length, buffer, size);
+    outbox->length += size;
+    return size;
+}
+
+/* Make a stream whose writes are queued rather than blocking the daemon,
+ * to be written to a pipe as it has room
+ *
+ * @param outbox - outbox to queue into
+ * @param fd - write end of the pipe, which is made non-blocking
+ * @return stream for the game to send messages on
+ */
+FILE* open_outbox(Outbox* outbox, int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    outbox->fd = fd;
+    outbox->data = NULL;
+    outbox->length = 0;
+    outbox->capacity = 0;
+    cookie_io_functions_t functions = {NULL, queue_output, NULL, NULL};
+    return fopencookie(outbox, "w", functions);
+}
+
+/* Write as much queued output as the pipe will take without blocking
+ *
+ * @param outbox - outbox to drain
+ * @return false if the reader has gone away, in which case the queued
+ * output is dropped
+ */
+bool drain_outbox(Outbox* outbox) {
+    size_t sent = 0;
+    while (sent < outbox->length) {
+        ssize_t wrote = write(outbox->fd, outbox->data + sent,
+                outbox->length - sent);
+        if (wrote == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                break;
+            }
+            outbox->length = 0;
+            return false;
+        }
+        sent += wrote;
+    }
+    outbox->length -= sent;
+    memmove(outbox->data, outbox->data + sent, outbox->length);
+    return true;
+}
+
+/* Close an outbox's pipe, dropping anything still queued
+ *
+ * @param outbox - outbox to close
+ */
+void close_outbox(Outbox* outbox) {
+    close(outbox->fd);
+    free(outbox->data);
+    outbox->fd = -1;
+}
+
+/* Send as much queued output to each of a table's own player processes as
+ * their pipes will take
+ * A player that has gone away is noticed through EOF when it is read from
+ *
+ * @param table - table whose game may have sent messages
+ */
+void flush_players(Table* table) {
+    for (int i = 0; table->outboxes != NULL
+            && i < table->game.numPlayers; i++) {
+        if (table->outboxes[i].fd != -1 && table->outboxes[i].length > 0) {
+            drain_outbox(&table->outboxes[i]);
+        }
+    }
+}
+
+/* Start a process for one of a table's seats, queueing what the game sends
+ * it instead of writing to its pipe directly
+ *
+ * @param table - table being started
+ * @param seat - seat to start a process for
+ * @return true if the process could not be started
+ */
+bool spawn_seat(Table* table, int seat) {
+    if (spawn_player(&table->game, seat, table->args[seat + 2]) != NORMAL) {
+        return true;
+    }
+    Player* player = &table->game.players[seat];
+    int fd = fcntl(fileno(player->write), F_DUPFD_CLOEXEC, 0);
+    fclose(player->write);
+    player->write = open_outbox(&table->outboxes[seat], fd);
+    return false;
+}
+
+/* Start a shared player process, serving games from any table
+ *
+ * @param executable - player to run
+ * @return the new channel, or NULL if the process could not be started
+ */
+Channel* spawn_channel(char* executable) {
+    int toPlayer[2], fromPlayer[2];
+    if (pipe(toPlayer)) {
+        return NULL;
+    }
+    if (pipe(fromPlayer)) {
+        close(toPlayer[0]);
+        close(toPlayer[1]);
+        return NULL;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(toPlayer[i], F_SETFD, FD_CLOEXEC);
+        fcntl(fromPlayer[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(toPlayer[0]);
+        close(toPlayer[1]);
+        close(fromPlayer[0]);
+        close(fromPlayer[1]);
+        return NULL;
+    } else if (pid == 0) { // player process
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(toPlayer[0], 0);
+        dup2(fromPlayer[1], 1);
+        dup2(devNull, 2);
+        execlp(executable, executable, MUX_ARG, (char*) 0);
+        _exit(0); // Shutdown if exec failed
+    }
+
+    close(toPlayer[0]);
+    close(fromPlayer[1]);
+    Channel* channel = calloc(1, sizeof(Channel));
+    channel->executable = strdup(executable);
+    channel->pid = pid;
+    channel->write = open_outbox(&channel->outbox, toPlayer[1]);
+    channel->read = fromPlayer[0];
+    return channel;
+}
+
+/* Pick the least loaded shared process for an executable with a free game
+ * id, starting another while there are fewer than the pool size and all of
+ * them are busy, or beyond the pool size if every one is out of ids
+ *
+ * @param daemon - daemon state
+ * @param executable - player to run
+ * @return channel to use, or NULL if none could be started
+ */
+Channel* choose_channel(Daemon* daemon, char* executable) {
+    Channel* best = NULL;
+    int count = 0;
+    for (int i = 0; i < daemon->numChannels; i++) {
+        Channel* channel = daemon->channels[i];
+        if (!channel->dead && strcmp(channel->executable, executable) == 0) {
+            count++;
+            if (channel->load < MUX_MAX_GAMES
+                    && (best == NULL || channel->load < best->load)) {
+                best = channel;
+            }
+        }
+    }
+    if (best == NULL || (count < daemon->poolSize && best->load > 0)) {
+        Channel* channel = spawn_channel(executable);
+        if (channel != NULL) {
+            daemon->channels = realloc(daemon->channels,
+                    sizeof(Channel*) * (daemon->numChannels + 1));
+            daemon->channels[daemon->numChannels++] = channel;
+            best = channel;
+        }
+    }
+    return best;
+}
+
+/* Serve a table's seat from a shared process, under the lowest free id
+ *
+ * @param daemon - daemon state
+ * @param table - table being started
+ * @param seat - seat to serve
+ * @return true if no shared process could take the seat
+ */
+bool attach_seat(Daemon* daemon, Table* table, int seat) {
+    Channel* channel = choose_channel(daemon, table->args[seat + 2]);
+    if (channel == NULL) {
+        return true;
+    }
+    int id = 0;
+    while (id < channel->numSlots && (channel->slots[id].table != NULL
+            || channel->slots[id].closing)) {
+        id++;
+    }
+    if (id == channel->numSlots) {
+        channel->slots = realloc(channel->slots,
+                sizeof(Slot) * ++channel->numSlots);
+    }
+    channel->slots[id].table = table;
+    channel->slots[id].seat = seat;
+    channel->slots[id].closing = false;
+    channel->load++;
+
+    Player* player = &table->game.players[seat];
+    player->tag = id;
+    player->write = channel->write;
+    table->channels[seat] = channel;
+    fprintf(channel->write, "%d %s %d %d %d %d\n", id, MUX_OPEN,
+            table->game.numPlayers, seat, table->game.threshold,
+            table->game.handSize);
+    fflush(channel->write);
+    return !drain_outbox(&channel->outbox);
+}
+
+/* Stop serving a table's seat from its shared process
+ * The id stays taken until the player sends END for it
+ *
+ * @param table - table whose game is finishing
+ * @param seat - seat served by a shared process
+ * @param abandon - tell the player to drop the game, as it will not get
+ * GAMEOVER
+ */
+void detach_seat(Table* table, int seat, bool abandon) {
+    Channel* channel = table->channels[seat];
+    Player* player = &table->game.players[seat];
+    Slot* slot = &channel->slots[player->tag];
+    slot->table = NULL;
+    slot->closing = true;
+    if (abandon && !channel->dead) {
+        char buffer[MESSAGE_SIZE];
+        fprintf(channel->write, "%d ", player->tag);
+        fwrite(buffer, 1, encode_game_over(buffer), channel->write);
+        fflush(channel->write);
+        drain_outbox(&channel->outbox);
+    }
+    player->write = NULL; // shared, so not closed with the table's players
+    table->channels[seat] = NULL;
+}
+
+/* Stop a table's game (if any) and queue its final status line
+ *
+ * @param daemon - daemon state
+ * @param table - table to finish
+ * @param status - reason the game stopped
+ */
+void finish_table(Daemon* daemon, Table* table, enum ExitStatus status) {
+    if (table->hasGame) {
+        if (status != NORMAL) {
+            kill_players(&table->game);
+        }
+        publish_end(&table->game, status);
+        for (int i = 0; table->channels != NULL
+                && i < table->game.numPlayers; i++) {
+            if (table->channels[i] != NULL) {
+                detach_seat(table, i, status != NORMAL);
+            }
+        }
+        close_players(&table->game);
+        for (int i = 0; i < table->game.numPlayers; i++) {
+            if (table->outboxes[i].fd != -1) {
+                drain_outbox(&table->outboxes[i]); // GAMEOVER, if it fits
+                close_outbox(&table->outboxes[i]);
+            }
+        }
+        free_game(&table->game);
+        free(table->inboxes);
+        free(table->outboxes);
+        table->outboxes = NULL;
+        free(table->channels);
+        table->hasGame = false;
+        daemon->activeGames--;
+    }
+    const char* message = status_message(status);
+    if (message != NULL) {
+        fprintf(table->output, "Exit=%d %s\n", status, message);
+    } else {
+        fprintf(table->output, "Exit=%d\n", status);
+    }
+    table->state = FLUSHING;
+}
+
+/* Give up on a table whose client has gone away, stopping its game
+ *
+ * @param daemon - daemon state
+ * @param table - table to abandon
+ */
+void abandon_table(Daemon* daemon, Table* table) {
+    if (table->hasGame) {
+        finish_table(daemon, table, PLAYER_ERROR);
+    }
+    table->state = FLUSHING;
+    fflush(table->output);
+    table->outputSent = table->outputSize;
+}
+
+/* Parse a complete request line: deck threshold player0 {player1}
+ * The deck may be a deckfile or seed=N for a generated deck
+ *
+ * @param table - table whose request has been read
+ * @return NORMAL if the game can be queued, otherwise the hub's error status
+ */
+enum ExitStatus parse_request(Table* table) {
+    table->numArgs = 0;
+    char* save;
+    for (char* token = strtok_r(table->request, " \t", &save); token != NULL;
+            token = strtok_r(NULL, " \t", &save)) {
+        table->args[table->numArgs++] = token;
+    }
+    if (table->numArgs < 3) {
+        return USAGE;
+    }
+
+    char* end;
+    int threshold = strtol(table->args[1], &end, 10);
+    if (threshold < 2 || *end) {
+        return INV_THRESHOLD;
+    }
+
+    int deckSize;
+    Card* deck;
+    if (strncmp(table->args[0], SEED_PREFIX, strlen(SEED_PREFIX)) == 0) {
+        unsigned long seed = strtoul(table->args[0] + strlen(SEED_PREFIX),
+                &end, 10);
+        deck = *end ? NULL : generate_deck(seed, &deckSize);
+    } else {
+        deck = read_deck_file(table->args[0], &deckSize);
+    }
+    if (deck == NULL) {
+        return DECK_ERROR;
+    }
+
+    int numPlayers = table->numArgs - 2;
+    if (deckSize < numPlayers) {
+        free(deck);
+        return INSUFF_CARDS;
+    }
+
+    table->game = setup_game(threshold, deckSize, deck, numPlayers);
+    table->game.output = table->output;
+    return NORMAL;
+}
+
+/* Start the players for a queued table
+ *
+ * @param daemon - daemon state
+ * @param table - table to start
+ */
+void start_table(Daemon* daemon, Table* table) {
+    table->hasGame = true;
+    table->game.spectators = daemon->spectators;
+    table->game.metrics = daemon->metrics;
+    table->game.gameId = table->arrival; // unique until it wraps
+    table->inboxes = calloc(table->game.numPlayers, sizeof(Inbox));
+    table->outboxes = malloc(sizeof(Outbox) * table->game.numPlayers);
+    for (int i = 0; i < table->game.numPlayers; i++) {
+        table->outboxes[i].fd = -1;
+    }
+    table->channels = daemon->poolSize == 0 ? NULL
+            : calloc(table->game.numPlayers, sizeof(Channel*));
+    table->ready = 0;
+    table->state = STARTING;
+    daemon->activeGames++;
+    for (int i = 0; i < table->game.numPlayers; i++) {
+        bool failed = daemon->poolSize == 0
+                ? spawn_seat(table, i)
+                : attach_seat(daemon, table, i);
+        if (failed) {
+            finish_table(daemon, table, PLAYER_ERROR);
+            return;
+        }
+    }
+}
+
+/* Start queued games, oldest first, while there is capacity for them
+ *
+ * @param daemon - daemon state
+ */
+void admit_games(Daemon* daemon) {
+    while (daemon->activeGames < daemon->maxGames) {
+        Table* oldest = NULL;
+        for (int i = 0; i < daemon->numTables; i++) {
+            Table* table = daemon->tables[i];
+            if (table->state == QUEUED &&
+                    (oldest == NULL || table->arrival < oldest->arrival)) {
+                oldest = table;
+            }
+        }
+        if (oldest == NULL) {
+            return;
+        }
+        start_table(daemon, oldest);
+    }
+}
+
+/* Count tables that have a request but no game running yet
+ *
+ * @param daemon - daemon state
+ * @return number of queued tables
+ */
+int count_queued(Daemon* daemon) {
+    int queued = 0;
+    for (int i = 0; i < daemon->numTables; i++) {
+        if (daemon->tables[i]->state == QUEUED) {
+            queued++;
+        }
+    }
+    return queued;
+}
+
+/* Accept a new client connection, turning it away if the daemon is full
+ *
+ * @param daemon - daemon state
+ */
+void accept_client(Daemon* daemon) {
+    int client = accept(daemon->listener, NULL, NULL);
+    if (client == -1) {
+        return;
+    }
+    fcntl(client, F_SETFD, FD_CLOEXEC);
+    if (daemon->numTables >= daemon->maxGames + daemon->maxQueued) {
+        send(client, "Busy\n", strlen("Busy\n"), MSG_NOSIGNAL | MSG_DONTWAIT);
+        close(client);
+        return;
+    }
+
+    Table* table = malloc(sizeof(Table));
+    table->client = client;
+    table->state = READING_REQUEST;
+    table->arrival = daemon->arrivals++;
+    table->requestLength = 0;
+    table->hasGame = false;
+    table->inboxes = NULL;
+    table->outboxes = NULL;
+    table->channels = NULL;
+    table->output = open_memstream(&table->outputData, &table->outputSize);
+    table->outputSent = 0;
+
+    daemon->tables = realloc(daemon->tables,
+            sizeof(Table*) * (daemon->numTables + 1));
+    daemon->tables[daemon->numTables++] = table;
+}
+
+/* Read request bytes from a client, queueing the game once the request
+ * line is complete
+ *
+ * @param daemon - daemon state
+ * @param table - table whose client is readable
+ * @return false if the client has gone away, true otherwise
+ */
+bool read_request(Daemon* daemon, Table* table) {
+    ssize_t got = read(table->client, table->request + table->requestLength,
+            MAX_REQUEST - 1 - table->requestLength);
+    if (got <= 0) {
+        return false;
+    }
+    table->requestLength += got;
+    table->request[table->requestLength] = '\0';
+
+    char* newline = strchr(table->request, '\n');
+    if (newline == NULL) {
+        if (table->requestLength == MAX_REQUEST - 1) {
+            finish_table(daemon, table, USAGE);
+        }
+        return true;
+    }
+    *newline = '\0';
+
+    if (count_queued(daemon) >= daemon->maxQueued) {
+        fprintf(table->output, "Busy\n");
+        table->state = FLUSHING;
+        return true;
+    }
+    enum ExitStatus status = parse_request(table);
+    if (status != NORMAL) {
+        finish_table(daemon, table, status);
+    } else {
+        table->state = QUEUED;
+    }
+    return true;
+}
+
+/* Find the player a starting or playing table is waiting to hear from
+ *
+ * @param table - table with a game
+ * @return index of player to read from
+ */
+int waiting_on(Table* table) {
+    return table->state == STARTING ? table->ready
+            : current_player(&table->game);
+}
+
+/* Act on whatever complete input the awaited player has sent, which may
+ * advance the game through several players' buffered messages
+ *
+ * @param daemon - daemon state
+ * @param table - table with a game
+ */
+void process_input(Daemon* daemon, Table* table) {
+    while (table->state == STARTING || table->state == PLAYING) {
+        Inbox* inbox = &table->inboxes[waiting_on(table)];
+        int consumed;
+        if (table->state == STARTING) {
+            if (inbox->length == 0) {
+                return;
+            }
+            if (inbox->data[0] != '@') {
+                finish_table(daemon, table, PLAYER_ERROR);
+                return;
+            }
+            consumed = 1;
+            if (++table->ready == table->game.numPlayers) {
+                table->state = PLAYING;
+                deal_hands(&table->game);
+            }
+        } else {
+            char* newline = memchr(inbox->data, '\n', inbox->length);
+            if (newline == NULL) {
+                if (inbox->length == MAX_LINE - 1) {
+                    finish_table(daemon, table, INV_MESSAGE);
+                }
+                return;
+            }
+            *newline = '\0';
+            consumed = newline - inbox->data + 1;
+            enum ExitStatus status = process_play(&table->game, inbox->data);
+            if (status != NORMAL) {
+                finish_table(daemon, table, status);
+                return;
+            }
+        }
+        inbox->length -= consumed;
+        memmove(inbox->data, inbox->data + consumed, inbox->length);
+        if (table->state == PLAYING && game_over(&table->game)) {
+            finish_table(daemon, table, NORMAL);
+        }
+    }
+}
+
+/* Read from the player a table is waiting on
+ *
+ * @param daemon - daemon state
+ * @param table - table whose awaited player is readable
+ */
+void read_player(Daemon* daemon, Table* table) {
+    int player = waiting_on(table);
+    Inbox* inbox = &table->inboxes[player];
+    int space = MAX_LINE - 1 - inbox->length;
+    int fd = fileno(table->game.players[player].read);
+    ssize_t got = read(fd, inbox->data + inbox->length,
+            space < READ_SIZE ? space : READ_SIZE);
+    if (got <= 0) {
+        finish_table(daemon, table,
+                table->state == STARTING ? PLAYER_ERROR : PLAYER_EOF);
+        return;
+    }
+    inbox->length += got;
+    process_input(daemon, table);
+}
+
+/* Give up on a shared player process, failing every game it was serving
+ * The channel is removed by the main loop
+ *
+ * @param daemon - daemon state
+ * @param channel - channel whose process has gone or misbehaved
+ */
+void close_channel(Daemon* daemon, Channel* channel) {
+    channel->dead = true;
+    kill(channel->pid, SIGKILL);
+    for (int id = 0; id < channel->numSlots; id++) {
+        Table* table = channel->slots[id].table;
+        if (table != NULL) {
+            finish_table(daemon, table,
+                    table->state == STARTING ? PLAYER_ERROR : PLAYER_EOF);
+        }
+    }
+}
+
+/* Pass one line from a shared process to the table its id is serving
+ * The table's inbox gets exactly what a player of its own would have sent
+ *
+ * @param daemon - daemon state
+ * @param channel - channel the line came from
+ * @param line - line without its newline, which may be overwritten
+ */
+void route_line(Daemon* daemon, Channel* channel, char* line) {
+    char* text;
+    long id = strtol(line, &text, 10);
+    if (text == line || *text++ != ' ' || id < 0 || id >= channel->numSlots) {
+        return;
+    }
+    Slot* slot = &channel->slots[id];
+    Table* table = slot->table;
+    if (strcmp(text, MUX_CLOSE) == 0) {
+        if (table == NULL && !slot->closing) {
+            return;
+        }
+        slot->closing = false;
+        channel->load--;
+        if (table != NULL) {
+            // the player gave up on a game still being played
+            detach_seat(table, slot->seat, false);
+            slot->closing = false;
+            finish_table(daemon, table,
+                    table->state == STARTING ? PLAYER_ERROR : PLAYER_EOF);
+        }
+        return;
+    }
+    if (table == NULL) {
+        return; // for a game that has already finished
+    }
+
+    Inbox* inbox = &table->inboxes[slot->seat];
+    int length = strlen(text);
+    if (strcmp(text, "@") != 0) {
+        text[length++] = '\n';
+    }
+    if (inbox->length + length > MAX_LINE - 1) {
+        finish_table(daemon, table, INV_MESSAGE);
+    } else {
+        memcpy(inbox->data + inbox->length, text, length);
+        inbox->length += length;
+        process_input(daemon, table);
+    }
+    flush_players(table);
+    if (!flush_output(table)) {
+        abandon_table(daemon, table);
+    }
+}
+
+/* Read from a shared process, passing each complete line to its table
+ *
+ * @param daemon - daemon state
+ * @param channel - readable channel
+ */
+void read_channel(Daemon* daemon, Channel* channel) {
+    Inbox* inbox = &channel->inbox;
+    int space = MAX_LINE - 1 - inbox->length;
+    ssize_t got = read(channel->read, inbox->data + inbox->length,
+            space < READ_SIZE ? space : READ_SIZE);
+    if (got <= 0) {
+        close_channel(daemon, channel);
+        return;
+    }
+    inbox->length += got;
+    char* start = inbox->data;
+    char* newline;
+    while ((newline = memchr(start, '\n',
+            inbox->data + inbox->length - start)) != NULL) {
+        *newline = '\0';
+        route_line(daemon, channel, start);
+        start = newline + 1;
+    }
+    inbox->length -= start - inbox->data;
+    memmove(inbox->data, start, inbox->length);
+    if (inbox->length == MAX_LINE - 1) {
+        close_channel(daemon, channel); // a line too long to be a message
+    }
+}
+
+/* Release a channel whose process has gone
+ *
+ * @param daemon - daemon state
+ * @param index - index of channel in the daemon's channel list
+ */
+void remove_channel(Daemon* daemon, int index) {
+    Channel* channel = daemon->channels[index];
+    fclose(channel->write);
+    close_outbox(&channel->outbox);
+    close(channel->read);
+    free(channel->slots);
+    free(channel->executable);
+    free(channel);
+    daemon->channels[index] = daemon->channels[--daemon->numChannels];
+}
+
+/* Release a table and its client connection
+ *
+ * @param daemon - daemon state
+ * @param index - index of table in the daemon's table list
+ */
+void remove_table(Daemon* daemon, int index) {
+    Table* table = daemon->tables[index];
+    close(table->client);
+    fclose(table->output);
+    free(table->outputData);
+    free(table);
+    daemon->tables[index] = daemon->tables[--daemon->numTables];
+}
+
+/* Reap players as they exit, whether after GAMEOVER or being killed
+ *
+ * @param signum - number of signal received
+ */
+static void sigchld_handler(int signum) {
+    int savedErrno = errno;
+    while (waitpid(-1, NULL, WNOHANG) > 0) {
+    }
+    errno = savedErrno;
+}
+
+/* Count the descriptors the main loop may poll for a table: its client or
+ * awaited player, and each seat with output queued
+ *
+ * @param table - table to count for
+ * @return most descriptors the table can need
+ */
+int count_watches(Table* table) {
+    return 1 + (table->outboxes == NULL ? 0 : table->game.numPlayers);
+}
+
+/* Add the descriptors to poll for a table
+ *
+ * @param table - table to watch
+ * @param fds - where to add descriptors
+ * @param watches - where to note what each added descriptor is for
+ * @return number of descriptors added
+ */
+int watch_table(Table* table, struct pollfd* fds, Watch* watches) {
+    int numFds = 0;
+    if (table->state == READING_REQUEST) {
+        fds[numFds].fd = table->client;
+        fds[numFds].events = POLLIN;
+        watches[numFds++] = (Watch) {table, NULL, INVALID};
+    } else if (table->state == STARTING || table->state == PLAYING) {
+        int player = waiting_on(table);
+        // a seat on a shared process is read through its channel
+        if (table->channels == NULL || table->channels[player] == NULL) {
+            fds[numFds].fd = fileno(table->game.players[player].read);
+            fds[numFds].events = POLLIN;
+            watches[numFds++] = (Watch) {table, NULL, INVALID};
+        }
+        for (int i = 0; i < table->game.numPlayers; i++) {
+            if (table->outboxes[i].fd != -1
+                    && table->outboxes[i].length > 0) {
+                fds[numFds].fd = table->outboxes[i].fd;
+                fds[numFds].events = POLLOUT;
+                watches[numFds++] = (Watch) {table, NULL, i};
+            }
+        }
+    } else if (table->state == FLUSHING) {
+        fds[numFds].fd = table->client;
+        fds[numFds].events = POLLOUT;
+        watches[numFds++] = (Watch) {table, NULL, INVALID};
+    }
+    return numFds;
+}
+
+/* Add the descriptors to poll for a shared process: the pipe it replies
+ * on, and the pipe to it while output is queued
+ *
+ * @param channel - channel to watch
+ * @param fds - where to add descriptors
+ * @param watches - where to note what each added descriptor is for
+ * @return number of descriptors added
+ */
+int watch_channel(Channel* channel, struct pollfd* fds, Watch* watches) {
+    int numFds = 0;
+    fds[numFds].fd = channel->read;
+    fds[numFds].events = POLLIN;
+    watches[numFds++] = (Watch) {NULL, channel, INVALID};
+    if (channel->outbox.length > 0) {
+        fds[numFds].fd = channel->outbox.fd;
+        fds[numFds].events = POLLOUT;
+        watches[numFds++] = (Watch) {NULL, channel, INVALID};
+    }
+    return numFds;
+}
+
+/* Handle a shared process's pipe becoming ready
+ *
+ * @param daemon - daemon state
+ * @param channel - channel whose pipe is ready
+ * @param output - the pipe to it has room, rather than it having replied
+ */
+void serve_channel(Daemon* daemon, Channel* channel, bool output) {
+    if (channel->dead) {
+        return;
+    }
+    if (!output) {
+        read_channel(daemon, channel);
+    } else if (!drain_outbox(&channel->outbox)) {
+        close_channel(daemon, channel);
+    }
+}
+
+/* Handle SIGTERM and SIGINT by noting them for the main loop
+ *
+ * @param signum - number of signal received
+ */
+static void sigterm_handler(int signum) {
+    int savedErrno = errno;
+    stopping = 1;
+    write(wakeup[1], "!", 1);
+    errno = savedErrno;
+}
+
+/* Stop every game, killing its players and telling its client if the
+ * client will take it, then remove the socket and spectate ring and
+ * detach from the metrics segment
+ *
+ * @param daemon - daemon state
+ */
+void shutdown_daemon(Daemon* daemon) {
+    for (int i = daemon->numTables - 1; i >= 0; i--) {
+        Table* table = daemon->tables[i];
+        if (table->hasGame) {
+            finish_table(daemon, table, SIGNAL_RECEIVED);
+        }
+        flush_output(table);
+        remove_table(daemon, i);
+    }
+    for (int i = daemon->numChannels - 1; i >= 0; i--) {
+        kill(daemon->channels[i]->pid, SIGKILL);
+        remove_channel(daemon, i);
+    }
+    close(daemon->listener);
+    unlink(daemon->path);
+    if (daemon->spectators != NULL) {
+        spectate_close(daemon->spectators, getenv(SPECTATE_ENV));
+    }
+    if (daemon->metrics != NULL) {
+        metrics_close(daemon->metrics);
+    }
+}
+
+/* Main event loop: accept clients, run games and stream their output
+ * Returns once SIGTERM or SIGINT has been received
+ *
+ * @param daemon - daemon state
+ */
+void serve(Daemon* daemon) {
+    struct pollfd* fds = NULL;
+    Watch* watches = NULL;
+    int capacity = 0;
+    while (!stopping) {
+        admit_games(daemon);
+
+        int needed = 2 * daemon->numChannels + 2;
+        for (int i = 0; i < daemon->numTables; i++) {
+            needed += count_watches(daemon->tables[i]);
+        }
+        if (capacity < needed) {
+            capacity = needed;
+            fds = realloc(fds, sizeof(struct pollfd) * capacity);
+            watches = realloc(watches, sizeof(Watch) * capacity);
+        }
+        int numFds = 0;
+        fds[numFds].fd = daemon->listener;
+        fds[numFds].events = POLLIN;
+        watches[numFds++] = (Watch) {NULL, NULL, INVALID};
+        fds[numFds].fd = wakeup[0];
+        fds[numFds].events = POLLIN;
+        watches[numFds++] = (Watch) {NULL, NULL, INVALID};
+        for (int i = 0; i < daemon->numTables; i++) {
+            numFds += watch_table(daemon->tables[i], fds + numFds,
+                    watches + numFds);
+        }
+        for (int i = 0; i < daemon->numChannels; i++) {
+            numFds += watch_channel(daemon->channels[i], fds + numFds,
+                    watches + numFds);
+        }
+
+        if (poll(fds, numFds, -1) == -1) {
+            continue;
+        }
+
+        for (int i = 2; i < numFds; i++) {
+            Table* table = watches[i].table;
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            if (watches[i].channel != NULL) {
+                serve_channel(daemon, watches[i].channel,
+                        fds[i].events & POLLOUT);
+                continue;
+            }
+            if (watches[i].seat != INVALID) {
+                // the game may have finished since this was polled
+                if (table->outboxes != NULL) {
+                    drain_outbox(&table->outboxes[watches[i].seat]);
+                }
+                continue;
+            }
+            if (table->state == READING_REQUEST) {
+                if (!read_request(daemon, table)) {
+                    abandon_table(daemon, table);
+                }
+            } else if (table->state == STARTING ||
+                    table->state == PLAYING) {
+                read_player(daemon, table);
+                flush_players(table);
+            }
+            if (!flush_output(table)) {
+                abandon_table(daemon, table);
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            accept_client(daemon);
+        }
+
+        // send whatever the games just played queued for shared processes
+        for (int i = 0; i < daemon->numChannels; i++) {
+            Channel* channel = daemon->channels[i];
+            if (!channel->dead && !drain_outbox(&channel->outbox)) {
+                close_channel(daemon, channel);
+            }
+        }
+        for (int i = daemon->numChannels - 1; i >= 0; i--) {
+            if (daemon->channels[i]->dead) {
+                remove_channel(daemon, i);
+            }
+        }
+        for (int i = daemon->numTables - 1; i >= 0; i--) {
+            Table* table = daemon->tables[i];
+            if (table->state == FLUSHING) {
+                fflush(table->output);
+                if (table->outputSent == table->outputSize) {
+                    remove_table(daemon, i);
+                }
+            }
+        }
+    }
+    free(fds);
+    free(watches);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 4) {
+        quit_daemon(DAEMON_USAGE);
+    }
+
+    Daemon daemon;
+    daemon.maxGames = DEFAULT_MAX_GAMES;
+    daemon.maxQueued = DEFAULT_MAX_QUEUED;
+    char* end;
+    if (argc > 2) {
+        daemon.maxGames = strtol(argv[2], &end, 10);
+        if (daemon.maxGames < 1 || *end) {
+            quit_daemon(DAEMON_USAGE);
+        }
+    }
+    if (argc > 3) {
+        daemon.maxQueued = strtol(argv[3], &end, 10);
+        if (daemon.maxQueued < 0 || *end) {
+            quit_daemon(DAEMON_USAGE);
+        }
+    }
+    daemon.tables = NULL;
+    daemon.numTables = 0;
+    daemon.activeGames = 0;
+    daemon.arrivals = 0;
+    daemon.spectators = NULL;
+    char* spectateName = getenv(SPECTATE_ENV);
+    if (spectateName != NULL && *spectateName != '\0') {
+        daemon.spectators = spectate_open(spectateName);
+    }
+    daemon.poolSize = 0;
+    char* poolSize = getenv(POOL_ENV);
+    if (poolSize != NULL && *poolSize != '\0') {
+        daemon.poolSize = strtol(poolSize, &end, 10);
+        if (daemon.poolSize < 1 || *end) {
+            quit_daemon(DAEMON_USAGE);
+        }
+    }
+    daemon.channels = NULL;
+    daemon.numChannels = 0;
+    daemon.metrics = NULL;
+    char* metricsName = getenv(METRICS_ENV);
+    if (metricsName != NULL && *metricsName != '\0') {
+        daemon.metrics = metrics_open(metricsName);
+    }
+
+    // Dead players and clients are noticed through EOF and send errors
+    signal(SIGPIPE, SIG_IGN);
+
+    struct sigaction saChld;
+    memset(&saChld, 0, sizeof(saChld));
+    saChld.sa_handler = sigchld_handler;
+    saChld.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &saChld, NULL);
+
+    if (pipe(wakeup)) {
+        quit_daemon(DAEMON_SOCKET);
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(wakeup[i], F_SETFD, FD_CLOEXEC);
+        fcntl(wakeup[i], F_SETFL, O_NONBLOCK);
+    }
+    struct sigaction saTerm;
+    memset(&saTerm, 0, sizeof(saTerm));
+    saTerm.sa_handler = sigterm_handler;
+    sigaction(SIGTERM, &saTerm, NULL);
+    sigaction(SIGINT, &saTerm, NULL);
+
+    daemon.path = argv[1];
+    daemon.listener = open_listener(argv[1]);
+    if (daemon.listener == -1) {
+        quit_daemon(DAEMON_SOCKET);
+    }
+
+    serve(&daemon);
+    shutdown_daemon(&daemon);
+    quit_daemon(DAEMON_NORMAL);
+}
@@ -0,0 +1,741 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "hubgame.h"
+#include "placement.h"
+#include "protocol.h"
+#include "trace.h"
+#include "util.h"
+
+/* Get the error message associated with an exit status
+ *
+ * @param status - the exit status
+ * @return message to print (without newline) or NULL for NORMAL
+ */
+const char* status_message(enum ExitStatus status) {
+    switch (status) {
+        case USAGE:
+            return "Usage: 2310hub deck threshold player0 {player1}";
+        case INV_THRESHOLD:
+            return "Invalid threshold";
+        case DECK_ERROR:
+            return "Deck error";
+        case INSUFF_CARDS:
+            return "Not enough cards";
+        case PLAYER_ERROR:
+            return "Player error";
+        case PLAYER_EOF:
+            return "Player EOF";
+        case INV_MESSAGE:
+            return "Invalid message";
+        case INV_CARD_CHOICE:
+            return "Invalid card choice";
+        case SIGNAL_RECEIVED:
+            return "Exit due to signal";
+        default:
+            return NULL;
+    }
+}
+
+/* Read a deckfile and create an array of cards representing its contents
+ *
+ * @param filename - name of deck file
+ * @param deckSize - pointer to store number of cards in deckfile into
+ * @return array of cards of length deckSize or NULL if file was erroneous
+ */
+Card* read_deck_file(char* filename, int* deckSize) {
+    FILE* deckFile = fopen(filename, "r");
+    if (deckFile == NULL) {
+        return NULL;
+    }
+    Card* deck = read_deck(deckFile, deckSize);
+    fclose(deckFile);
+    return deck;
+}
+
+/* Read a deck from an open stream
+ *
+ * @param deckFile - stream positioned at the start of the deck
+ * @param deckSize - pointer to store number of cards in deck into
+ * @return array of cards of length deckSize or NULL if deck was erroneous
+ */
+Card* read_deck(FILE* deckFile, int* deckSize) {
+    char* line;
+    int length = read_line(deckFile, &line);
+    char* end;
+    int numCards = strtol(line, &end, 10);
+    // end points into line, so check it before freeing
+    bool invalid = numCards <= 0 || *end;
+    free(line);
+    if (invalid) {
+        return NULL;
+    }
+
+    Card* deck = malloc(sizeof(Card) * numCards);
+    for (int i = 0; i < numCards; i++) {
+        length = read_line(deckFile, &line);
+        if (length != 2 || parse_card(line, &deck[i])) {
+            free(line);
+            free(deck);
+            return NULL;
+        }
+        free(line);
+    }
+    *deckSize = numCards;
+    return deck;
+}
+
+/* Create a shuffled deck holding every card exactly once
+ * The same seed always produces the same deck
+ *
+ * @param seed - seed for the shuffle
+ * @param deckSize - pointer to store number of cards in deck into
+ * @return array of cards of length deckSize
+ */
+Card* generate_deck(unsigned long seed, int* deckSize) {
+    Card* deck = malloc(sizeof(Card) * FULL_DECK);
+    shuffle_deck(seed, deck);
+    *deckSize = FULL_DECK;
+    return deck;
+}
+
+/* Set up a new game struct based on command line argument values
+ *
+ * @param threshold - threshold of diamond cards
+ * @param deckSize - number of cards in deck
+ * @param deck - array of cards from deckfile
+ * @param numPlayers - number of players in game
+ * @return main game struct
+ */
+Game setup_game(int threshold, int deckSize, Card* deck, int numPlayers) {
+    Game game;
+
+    arena_init(&game.arena);
+    game.deck = NULL;
+    game.output = stdout;
+    game.spectators = NULL;
+    game.metrics = NULL;
+    game.gameId = 0;
+    game.cpus = NULL;
+    game.sizePipes = false;
+    game.stop = NULL;
+    reset_game(&game, threshold, deckSize, deck, numPlayers);
+
+    return game;
+}
+
+/* Reuse a game struct for a new game, keeping its output, spectators,
+ * metrics, CPUs, pipe sizing and stop flag
+ * The per-round data (round cards, points and D cards won) is laid out
+ * together at the front of the game's arena, ahead of the players
+ * Player streams must already have been closed
+ *
+ * @param game - main game struct to reset
+ * @param threshold - threshold of diamond cards
+ * @param deckSize - number of cards in deck
+ * @param deck - array of cards, replacing (and freeing) the previous deck
+ * @param numPlayers - number of players in game
+ */
+void reset_game(Game* game, int threshold, int deckSize, Card* deck,
+        int numPlayers) {
+    arena_reset(&game->arena, ARENA_SIZE(sizeof(Card) * numPlayers)
+            + 2 * ARENA_SIZE(sizeof(int) * numPlayers)
+            + ARENA_SIZE(sizeof(Player) * numPlayers));
+    game->round = arena_alloc(&game->arena, sizeof(Card) * numPlayers);
+    game->points = arena_alloc(&game->arena, sizeof(int) * numPlayers);
+    game->dWon = arena_alloc(&game->arena, sizeof(int) * numPlayers);
+    game->players = arena_alloc(&game->arena, sizeof(Player) * numPlayers);
+
+    game->numPlayers = numPlayers;
+    for (int i = 0; i < numPlayers; i++) {
+        game->points[i] = 0;
+        game->dWon[i] = 0;
+        game->players[i].read = NULL;
+        game->players[i].write = NULL;
+        memset(game->players[i].cardCounts, 0,
+                sizeof(game->players[i].cardCounts));
+        memset(game->players[i].suitCounts, 0,
+                sizeof(game->players[i].suitCounts));
+        game->players[i].pid = INVALID;
+        game->players[i].tag = INVALID;
+        game->players[i].exited = false;
+        memset(&game->players[i].usage, 0, sizeof(game->players[i].usage));
+    }
+
+    free(game->deck);
+    game->deckSize = deckSize;
+    game->deck = deck;
+    game->threshold = threshold;
+    game->leadPlayer = 0;
+    game->handSize = game->deckSize / game->numPlayers;
+    game->roundsPlayed = 0;
+    game->playCount = 0;
+}
+
+/* Free everything allocated by setup_game, including the deck
+ * Player streams must already have been closed
+ *
+ * @param game - main game struct
+ */
+void free_game(Game* game) {
+    arena_free(&game->arena);
+    free(game->deck);
+}
+
+/* Fork and exec a single player, connecting its stdin and stdout to pipes
+ * Does not wait for the player to signal that it is ready
+ *
+ * @param game - main game struct
+ * @param player - index of player to start
+ * @param executable - player executable to run
+ * @return NORMAL on success or PLAYER_ERROR
+ */
+enum ExitStatus spawn_player(Game* game, int player, char* executable) {
+    char numPlayersArg[ARG_SIZE], thresholdArg[ARG_SIZE], handArg[ARG_SIZE];
+    char playerIDArg[ARG_SIZE];
+    sprintf(numPlayersArg, "%d", game->numPlayers);
+    sprintf(playerIDArg, "%d", player);
+    sprintf(thresholdArg, "%d", game->threshold);
+    sprintf(handArg, "%d", game->handSize);
+
+    // Close-on-exec keeps other players (and games) from inheriting our
+    // pipe ends, which would stop EOF being seen on them
+    int hubToPlayer[2], playerToHub[2];
+    if (pipe(hubToPlayer)) {
+        return PLAYER_ERROR;
+    }
+    if (pipe(playerToHub)) {
+        close(hubToPlayer[0]);
+        close(hubToPlayer[1]);
+        return PLAYER_ERROR;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(hubToPlayer[i], F_SETFD, FD_CLOEXEC);
+        fcntl(playerToHub[i], F_SETFD, FD_CLOEXEC);
+    }
+    if (game->sizePipes) {
+        // the whole hand fits at once, as does a round of PLAYED messages,
+        // without using more pages than that needs
+        int bytes = MESSAGE_SIZE * (game->numPlayers + 1);
+        if (bytes < HAND_MESSAGE_SIZE(game->handSize)) {
+            bytes = HAND_MESSAGE_SIZE(game->handSize);
+        }
+        size_pipe(hubToPlayer[1], bytes);
+        size_pipe(playerToHub[1], MESSAGE_SIZE);
+    }
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(hubToPlayer[0]);
+        close(hubToPlayer[1]);
+        close(playerToHub[0]);
+        close(playerToHub[1]);
+        return PLAYER_ERROR;
+    } else if (pid == 0) { // player process
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(hubToPlayer[0], 0);
+        dup2(playerToHub[1], 1);
+        dup2(devNull, 2);
+        if (game->cpus != NULL) {
+            pin_to_cpu(game->cpus[player]);
+        }
+
+        execlp(executable, executable, numPlayersArg, playerIDArg,
+                thresholdArg, handArg, (char*) 0);
+        _exit(0); // Shutdown if exec failed
+    }
+
+    // parent process
+    game->players[player].pid = pid;
+    game->players[player].read = fdopen(playerToHub[0], "r");
+    game->players[player].write = fdopen(hubToPlayer[1], "a");
+    close(playerToHub[1]);
+    close(hubToPlayer[0]);
+    return NORMAL;
+}
+
+/* Start all players in the game, waiting for each to send '@'
+ *
+ * @param game - main game struct
+ * @param playerExecutables - list of player executables to run, from argv
+ * @return NORMAL on success or PLAYER_ERROR if unable to start any player
+ * (or once the game's stop flag is set)
+ */
+enum ExitStatus start_players(Game* game, char** playerExecutables) {
+    for (int i = 0; i < game->numPlayers; i++) {
+        if (spawn_player(game, i, playerExecutables[i]) != NORMAL
+                || (game->stop != NULL && *game->stop)) {
+            return PLAYER_ERROR;
+        }
+        if (fgetc(game->players[i].read) != '@') {
+            return PLAYER_ERROR;
+        }
+    }
+    return NORMAL;
+}
+
+/* SIGKILL every started player that has not been reaped
+ *
+ * @param game - main game struct
+ */
+void kill_players(Game* game) {
+    for (int i = 0; i < game->numPlayers; i++) {
+        if (game->players[i].pid != INVALID && !game->players[i].exited) {
+            kill(game->players[i].pid, SIGKILL);
+        }
+    }
+}
+
+/* Close the streams to every started player
+ *
+ * @param game - main game struct
+ */
+void close_players(Game* game) {
+    for (int i = 0; i < game->numPlayers; i++) {
+        if (game->players[i].read != NULL) {
+            fclose(game->players[i].read);
+            game->players[i].read = NULL;
+        }
+        if (game->players[i].write != NULL) {
+            fclose(game->players[i].write);
+            game->players[i].write = NULL;
+        }
+    }
+}
+
+/* Reap every started player, recording what each used
+ * Players get up to PLAYER_GRACE milliseconds to exit by themselves (after
+ * GAMEOVER, or after SIGTERM if asked to terminate them) and any still
+ * running after that are SIGKILLed; waiting ends as soon as the last one
+ * exits
+ *
+ * @param game - main game struct
+ * @param terminate - send players SIGTERM first
+ */
+void stop_players(Game* game, bool terminate) {
+    for (int i = 0; terminate && i < game->numPlayers; i++) {
+        if (game->players[i].pid != INVALID && !game->players[i].exited) {
+            kill(game->players[i].pid, SIGTERM);
+        }
+    }
+    // SIGCHLD stays pending while blocked, so waiting for it wakes as soon
+    // as a player exits, even one that exited before the wait began
+    sigset_t childExits, previous;
+    sigemptyset(&childExits);
+    sigaddset(&childExits, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &childExits, &previous);
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (true) {
+        bool running = false;
+        for (int i = 0; i < game->numPlayers; i++) {
+            Player* player = &game->players[i];
+            if (player->pid == INVALID || player->exited) {
+                continue;
+            }
+            pid_t reaped = wait4(player->pid, NULL, WNOHANG, &player->usage);
+            // -1 means it has already been reaped elsewhere
+            player->exited = reaped != 0;
+            running |= reaped == 0;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long waited = (now.tv_sec - start.tv_sec) * 1000000000L
+                + now.tv_nsec - start.tv_nsec;
+        if (!running || waited >= PLAYER_GRACE * 1000000L) {
+            break;
+        }
+        long remaining = PLAYER_GRACE * 1000000L - waited;
+        struct timespec timeout = {remaining / 1000000000L,
+                remaining % 1000000000L};
+        sigtimedwait(&childExits, NULL, &timeout);
+    }
+    sigprocmask(SIG_SETMASK, &previous, NULL);
+    kill_players(game);
+    for (int i = 0; i < game->numPlayers; i++) {
+        Player* player = &game->players[i];
+        if (player->pid != INVALID && !player->exited) {
+            wait4(player->pid, NULL, 0, &player->usage);
+            player->exited = true;
+        }
+    }
+}
+
+/* Print what each reaped player used, one "Usage=" line per seat
+ * CPU times are in seconds and max RSS in kilobytes
+ *
+ * @param game - main game struct, whose players have been stopped
+ */
+void print_usage(Game* game) {
+    for (int i = 0; i < game->numPlayers; i++) {
+        Player* player = &game->players[i];
+        if (!player->exited) {
+            continue;
+        }
+        fprintf(game->output, "Usage=%d user=%ld.%06ld sys=%ld.%06ld "
+                "maxrss=%ld voluntary=%ld involuntary=%ld\n", i,
+                (long) player->usage.ru_utime.tv_sec,
+                (long) player->usage.ru_utime.tv_usec,
+                (long) player->usage.ru_stime.tv_sec,
+                (long) player->usage.ru_stime.tv_usec,
+                player->usage.ru_maxrss, player->usage.ru_nvcsw,
+                player->usage.ru_nivcsw);
+    }
+}
+
+/* Publish an event to spectators, if there are any
+ * Costs one branch when nobody is watching
+ *
+ * @param game - main game struct
+ * @param event - kind of event
+ * @param player - player concerned, or INVALID
+ * @param card - card concerned, or NO_CARD
+ * @param number - extra detail, depending on event
+ */
+static void publish(Game* game, enum SpectateEvent event, int player,
+        Card card, int number) {
+    if (game->spectators == NULL) {
+        return;
+    }
+    SpectateRecord record;
+    record.game = game->gameId;
+    record.event = event;
+    record.card = card;
+    record.player = player;
+    record.round = game->roundsPlayed;
+    record.number = number;
+    spectate_publish(game->spectators, &record);
+}
+
+/* Determine which player won a round
+ *
+ * @param game - main game struct
+ * @return index of player who won the round
+ */
+static int find_winner(Game* game) {
+    int winner = round_winner(game->round, game->numPlayers);
+    return (winner + game->leadPlayer) % game->numPlayers;
+}
+
+/* Count a message sent to or received from a player in the metrics
+ * segment, if there is one
+ *
+ * @param game - main game struct
+ * @param player - player the message went to or came from
+ * @param length - length of the message, including newline
+ */
+static void count_message(Game* game, int player, int length) {
+    if (game->metrics != NULL && player < METRICS_SEATS) {
+        metrics_add(&game->metrics->messages[player], 1);
+        metrics_add(&game->metrics->bytes[player], length);
+    }
+}
+
+/* Send an encoded message to a player, tagged with its game id if the
+ * player is a shared process serving many games
+ *
+ * @param game - main game struct
+ * @param player - player to send to
+ * @param buffer - encoded message
+ * @param length - length of the message, including newline
+ */
+static void send_message(Game* game, int player, const char* buffer,
+        int length) {
+    if (game->players[player].tag != INVALID) {
+        fprintf(game->players[player].write, "%d ", game->players[player].tag);
+    }
+    fwrite(buffer, 1, length, game->players[player].write);
+    fflush(game->players[player].write);
+    count_message(game, player, length);
+}
+
+/* Start a new round, telling every player who leads it
+ *
+ * @param game - main game struct
+ */
+static void start_round(Game* game) {
+    char buffer[MESSAGE_SIZE];
+    int length = encode_new_round(buffer, game->leadPlayer);
+    for (int i = 0; i < game->numPlayers; i++) {
+        send_message(game, i, buffer, length);
+        trace_event(TRACE_SENT, NEW_ROUND, i, game->leadPlayer, NO_CARD);
+    }
+
+    fprintf(game->output, "Lead player=%d\n", game->leadPlayer);
+    game->playCount = 0;
+}
+
+/* Finish a round once every player has played, awarding the winner
+ *
+ * @param game - main game struct
+ */
+static void end_round(Game* game) {
+    fprintf(game->output, "Cards=");
+    for (int i = 0; i < game->numPlayers; i++) {
+        fprintf(game->output, "%c.%x", suit_char(card_suit(game->round[i])),
+                card_rank(game->round[i]));
+        if (i == game->numPlayers - 1) {
+            fprintf(game->output, "\n");
+        } else {
+            fprintf(game->output, " ");
+        }
+    }
+
+    int winner = find_winner(game);
+    trace_round(game->leadPlayer, winner,
+            game->round[(winner - game->leadPlayer + game->numPlayers)
+            % game->numPlayers]);
+    publish(game, SPECTATE_ROUND, winner,
+            game->round[(winner - game->leadPlayer + game->numPlayers)
+            % game->numPlayers], game->leadPlayer);
+    game->points[winner]++;
+    game->leadPlayer = winner;
+    for (int i = 0; i < game->numPlayers; i++) {
+        if (card_suit(game->round[i]) == PENALTY_SUIT) {
+            game->dWon[winner]++;
+        }
+    }
+    game->roundsPlayed++;
+    if (game->metrics != NULL) {
+        metrics_add(&game->metrics->rounds, 1);
+        __atomic_store_n(&game->metrics->currentRound, game->roundsPlayed + 1,
+                __ATOMIC_RELAXED);
+    }
+}
+
+/* Tell players the game is over and print final scores
+ *
+ * @param game - main game struct
+ */
+static void end_game(Game* game) {
+    char buffer[MESSAGE_SIZE];
+    int length = encode_game_over(buffer);
+    for (int i = 0; i < game->numPlayers; i++) {
+        send_message(game, i, buffer, length);
+        trace_event(TRACE_SENT, GAME_OVER, i, 0, NO_CARD);
+    }
+
+    for (int i = 0; i < game->numPlayers; i++) {
+        int score;
+        if (game->dWon[i] < game->threshold) {
+            score = game->points[i] - game->dWon[i];
+        } else {
+            score = game->points[i] + game->dWon[i];
+        }
+        fprintf(game->output, "%d:%d", i, score);
+        publish(game, SPECTATE_SCORE, i, NO_CARD, score);
+        if (i == game->numPlayers - 1) {
+            fprintf(game->output, "\n");
+        } else {
+            fprintf(game->output, " ");
+        }
+    }
+}
+
+/* Send each player their hand and start the first round
+ *
+ * @param game - main game struct
+ */
+void deal_hands(Game* game) {
+    publish(game, SPECTATE_START, game->numPlayers, NO_CARD, game->threshold);
+    if (game->metrics != NULL) {
+        metrics_add(&game->metrics->gamesStarted, 1);
+        __atomic_store_n(&game->metrics->currentRound, 1, __ATOMIC_RELAXED);
+    }
+    char* buffer = malloc(HAND_MESSAGE_SIZE(game->handSize));
+    for (int i = 0; i < game->numPlayers; i++) {
+        Card* hand = game->deck + i * game->handSize;
+        for (int j = 0; j < game->handSize; j++) {
+            game->players[i].cardCounts[hand[j]]++;
+            game->players[i].suitCounts[card_suit(hand[j])]++;
+        }
+        send_message(game, i, buffer,
+                encode_hand(buffer, hand, game->handSize));
+        trace_event(TRACE_SENT, HAND, i, game->handSize, NO_CARD);
+    }
+    free(buffer);
+
+    if (game_over(game)) {
+        end_game(game);
+    } else {
+        start_round(game);
+    }
+}
+
+/* Parse a PLAY message the strict decoder rejected the way the hub always
+ * has, so ranks with upper case digits, 0x prefixes or padding still go on
+ * to the card checks rather than being invalid messages
+ *
+ * @param message - line received from the player
+ * @param card - pointer to store the card named into
+ * @return false if the message named a card, true otherwise
+ */
+static bool parse_loose_play(const char* message, Card* card) {
+    char suit;
+    unsigned int rank;
+    char end;
+    if (sscanf(message, "PLAY%c%x%c", &suit, &rank, &end) != 2 ||
+            rank > MAX_RANK || parse_suit(suit) == -1) {
+        return true;
+    }
+    *card = make_card(parse_suit(suit), rank);
+    return false;
+}
+
+/* Get a PLAY message from the current player
+ *
+ * @param game - main game struct
+ * @param player - player index the message came from
+ * @param message - line received from the player
+ * @param card - pointer to store the card the player chose into
+ * @return NORMAL, INV_MESSAGE or INV_CARD_CHOICE
+ */
+enum ExitStatus get_play(Game* game, int player, char* message,
+        Card* card) {
+    count_message(game, player, strlen(message) + 1);
+    Message decoded;
+    enum MessageType type = decode_message(message, &decoded, NULL, 0);
+    if (type == INVALID_MESSAGE && !parse_loose_play(message, &decoded.card)) {
+        type = PLAY;
+    }
+    trace_event(TRACE_RECEIVED, type, player, decoded.number, decoded.card);
+    if (type != PLAY) {
+        return INV_MESSAGE;
+    }
+    *card = decoded.card;
+
+    Player* details = &game->players[player];
+    Suit leadSuit = card_suit(game->round[0]);
+    if (details->cardCounts[*card] == 0) {
+        // don't have card
+        return INV_CARD_CHOICE;
+    }
+    if (player != game->leadPlayer && card_suit(*card) != leadSuit &&
+            details->suitCounts[leadSuit] > 0) {
+        // not following lead suit while holding it
+        return INV_CARD_CHOICE;
+    }
+    return NORMAL;
+}
+
+/* Find the player whose PLAY message the game is waiting for
+ *
+ * @param game - main game struct
+ * @return index of player expected to play next
+ */
+int current_player(Game* game) {
+    return (game->leadPlayer + game->playCount) % game->numPlayers;
+}
+
+/* Check whether every round of the game has been played
+ *
+ * @param game - main game struct
+ * @return true iff the game is over
+ */
+bool game_over(Game* game) {
+    return game->roundsPlayed == game->handSize;
+}
+
+/* Handle a PLAY message from the current player
+ * Records the card, informs other players and finishes the round (and the
+ * game) once every player has played
+ *
+ * @param game - main game struct
+ * @param message - line received from the current player
+ * @return NORMAL, INV_MESSAGE or INV_CARD_CHOICE
+ */
+enum ExitStatus process_play(Game* game, char* message) {
+    int currentPlayer = current_player(game);
+    Card card;
+    enum ExitStatus status = get_play(game, currentPlayer, message, &card);
+    if (status != NORMAL) {
+        return status;
+    }
+
+    // store card
+    int i = game->playCount++;
+    game->round[i] = card;
+    // send info to other players
+    char buffer[MESSAGE_SIZE];
+    int length = encode_played(buffer, currentPlayer, card);
+    for (int j = 0; j < game->numPlayers; j++) {
+        if (j != currentPlayer) {
+            send_message(game, j, buffer, length);
+            trace_event(TRACE_SENT, PLAYED, j, currentPlayer, card);
+        }
+    }
+    // spectators hear about the play only once the next player can act
+    publish(game, SPECTATE_PLAY, currentPlayer, card, 0);
+    // remove card from hand
+    game->players[currentPlayer].cardCounts[card]--;
+    game->players[currentPlayer].suitCounts[card_suit(card)]--;
+
+    if (game->playCount == game->numPlayers) {
+        end_round(game);
+        if (game_over(game)) {
+            end_game(game);
+        } else {
+            start_round(game);
+        }
+    }
+    return NORMAL;
+}
+
+/* Tell spectators (if any) that the game has stopped, and count how it
+ * stopped in the metrics segment (if any)
+ *
+ * @param game - main game struct
+ * @param status - reason the game stopped
+ */
+void publish_end(Game* game, enum ExitStatus status) {
+    publish(game, SPECTATE_END, INVALID, NO_CARD, status);
+    if (game->metrics == NULL) {
+        return;
+    }
+    if (status == NORMAL) {
+        metrics_add(&game->metrics->gamesCompleted, 1);
+    } else if (status == INV_MESSAGE || status == INV_CARD_CHOICE) {
+        metrics_add(&game->metrics->invalidExits, 1);
+    } else if (status == PLAYER_EOF) {
+        metrics_add(&game->metrics->eofExits, 1);
+    } else {
+        metrics_add(&game->metrics->otherExits, 1);
+    }
+}
+
+/* Play entire game, blocking on each player in turn
+ * Stops after the read in progress once the game's stop flag is set
+ *
+ * @param game - main game struct
+ * @return NORMAL if the game completed, otherwise reason it stopped
+ */
+enum ExitStatus play_game(Game* game) {
+    deal_hands(game);
+    while (!game_over(game)) {
+        FILE* read = game->players[current_player(game)].read;
+        char* message;
+        read_line(read, &message);
+        // a signal interrupting the read leaves a partial message
+        if (game->stop != NULL && *game->stop) {
+            free(message);
+            return SIGNAL_RECEIVED;
+        }
+        if (feof(read)) {
+            free(message);
+            return PLAYER_EOF;
+        }
+        enum ExitStatus status = process_play(game, message);
+        free(message);
+        if (status != NORMAL) {
+            return status;
+        }
+    }
+    return NORMAL;
+}
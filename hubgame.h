@@ -0,0 +1,239 @@
+#ifndef HUBGAME_H
+#define HUBGAME_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+
+#include "arena.h"
+#include "card.h"
+#include "metrics.h"
+#include "spectate.h"
+
+#define INVALID -1
+#define ARG_SIZE 12 // fits any integer
+#define PLAYER_GRACE 100 // milliseconds players get to exit when stopped
+#define USAGE_ENV "USAGE_2310" // print each player's resource usage
+
+// Enum for all hub exit statuses
+enum ExitStatus {
+    NORMAL = 0,
+    USAGE = 1,
+    INV_THRESHOLD = 2,
+    DECK_ERROR = 3,
+    INSUFF_CARDS = 4,
+    PLAYER_ERROR = 5,
+    PLAYER_EOF = 6,
+    INV_MESSAGE = 7,
+    INV_CARD_CHOICE = 8,
+    SIGNAL_RECEIVED = 9
+};
+
+// Properties associated with each player
+typedef struct {
+    FILE* read;
+    FILE* write;
+    int cardCounts[NUM_SUITS * NUM_RANKS]; // copies of each card held
+    int suitCounts[NUM_SUITS]; // cards held in each suit
+    pid_t pid; // INVALID if not started, or served by a shared process
+    int tag; // game id prefixed to messages on a shared channel, or INVALID
+    bool exited; // reaped, so usage is filled in
+    struct rusage usage; // resources used, once reaped
+} Player;
+
+// Main game state, stores all players
+typedef struct {
+    Arena arena; // holds the players and per-round data
+    int numPlayers;
+    Player* players;
+    int deckSize;
+    Card* deck;
+    int threshold;
+    int leadPlayer;
+    int handSize;
+    Card* round;
+    int* points; // rounds won by each player
+    int* dWon; // D cards won by each player
+    FILE* output; // where round and score lines are printed
+    int roundsPlayed; // number of completed rounds
+    int playCount; // number of cards played in the current round
+    SpectateRing* spectators; // where round events are published, or NULL
+    unsigned int gameId; // identifies this game to spectators
+    Metrics* metrics; // where live counters are kept, or NULL
+    int* cpus; // CPU to pin each seat to, or NULL to let the kernel choose
+    bool sizePipes; // shrink each player's pipes to fit their messages
+    volatile sig_atomic_t* stop; // set by a signal handler, or NULL
+} Game;
+
+/* Get the error message associated with an exit status
+ *
+ * @param status - the exit status
+ * @return message to print (without newline) or NULL for NORMAL
+ */
+const char* status_message(enum ExitStatus status);
+
+/* Read a deckfile and create an array of cards representing its contents
+ *
+ * @param filename - name of deck file
+ * @param deckSize - pointer to store number of cards in deckfile into
+ * @return array of cards of length deckSize or NULL if file was erroneous
+ */
+Card* read_deck_file(char* filename, int* deckSize);
+
+/* Read a deck from an open stream
+ *
+ * @param deckFile - stream positioned at the start of the deck
+ * @param deckSize - pointer to store number of cards in deck into
+ * @return array of cards of length deckSize or NULL if deck was erroneous
+ */
+Card* read_deck(FILE* deckFile, int* deckSize);
+
+/* Create a shuffled deck holding every card exactly once
+ * The same seed always produces the same deck
+ *
+ * @param seed - seed for the shuffle
+ * @param deckSize - pointer to store number of cards in deck into
+ * @return array of cards of length deckSize
+ */
+Card* generate_deck(unsigned long seed, int* deckSize);
+
+/* Set up a new game struct based on command line argument values
+ *
+ * @param threshold - threshold of diamond cards
+ * @param deckSize - number of cards in deck
+ * @param deck - array of cards from deckfile
+ * @param numPlayers - number of players in game
+ * @return main game struct
+ */
+Game setup_game(int threshold, int deckSize, Card* deck, int numPlayers);
+
+/* Free everything allocated by setup_game, including the deck
+ * Player streams must already have been closed
+ *
+ * @param game - main game struct
+ */
+void free_game(Game* game);
+
+/* Reuse a game struct for a new game, keeping its output, spectators,
+ * metrics, CPUs, pipe sizing and stop flag
+ * The per-round data (round cards, points and D cards won) is laid out
+ * together at the front of the game's arena, ahead of the players
+ * Player streams must already have been closed
+ *
+ * @param game - main game struct to reset
+ * @param threshold - threshold of diamond cards
+ * @param deckSize - number of cards in deck
+ * @param deck - array of cards, replacing (and freeing) the previous deck
+ * @param numPlayers - number of players in game
+ */
+void reset_game(Game* game, int threshold, int deckSize, Card* deck,
+        int numPlayers);
+
+/* Fork and exec a single player, connecting its stdin and stdout to pipes
+ * Does not wait for the player to signal that it is ready
+ *
+ * @param game - main game struct
+ * @param player - index of player to start
+ * @param executable - player executable to run
+ * @return NORMAL on success or PLAYER_ERROR
+ */
+enum ExitStatus spawn_player(Game* game, int player, char* executable);
+
+/* Start all players in the game, waiting for each to send '@'
+ *
+ * @param game - main game struct
+ * @param playerExecutables - list of player executables to run, from argv
+ * @return NORMAL on success or PLAYER_ERROR if unable to start any player
+ * (or once the game's stop flag is set)
+ */
+enum ExitStatus start_players(Game* game, char** playerExecutables);
+
+/* SIGKILL every started player that has not been reaped
+ *
+ * @param game - main game struct
+ */
+void kill_players(Game* game);
+
+/* Close the streams to every started player
+ *
+ * @param game - main game struct
+ */
+void close_players(Game* game);
+
+/* Reap every started player, recording what each used
+ * Players get up to PLAYER_GRACE milliseconds to exit by themselves (after
+ * GAMEOVER, or after SIGTERM if asked to terminate them) and any still
+ * running after that are SIGKILLed; waiting ends as soon as the last one
+ * exits
+ *
+ * @param game - main game struct
+ * @param terminate - send players SIGTERM first
+ */
+void stop_players(Game* game, bool terminate);
+
+/* Print what each reaped player used, one "Usage=" line per seat
+ * CPU times are in seconds and max RSS in kilobytes
+ *
+ * @param game - main game struct, whose players have been stopped
+ */
+void print_usage(Game* game);
+
+/* Send each player their hand and start the first round
+ *
+ * @param game - main game struct
+ */
+void deal_hands(Game* game);
+
+/* Check a PLAY message from a player against the cards they hold
+ *
+ * @param game - main game struct
+ * @param player - player index the message came from
+ * @param message - line received from the player
+ * @param card - pointer to store the card the player chose into
+ * @return NORMAL, INV_MESSAGE or INV_CARD_CHOICE
+ */
+enum ExitStatus get_play(Game* game, int player, char* message, Card* card);
+
+/* Find the player whose PLAY message the game is waiting for
+ *
+ * @param game - main game struct
+ * @return index of player expected to play next
+ */
+int current_player(Game* game);
+
+/* Check whether every round of the game has been played
+ *
+ * @param game - main game struct
+ * @return true iff the game is over
+ */
+bool game_over(Game* game);
+
+/* Handle a PLAY message from the current player
+ * Records the card, informs other players and finishes the round (and the
+ * game) once every player has played
+ *
+ * @param game - main game struct
+ * @param message - line received from the current player
+ * @return NORMAL, INV_MESSAGE or INV_CARD_CHOICE
+ */
+enum ExitStatus process_play(Game* game, char* message);
+
+/* Tell spectators (if any) that the game has stopped, and count how it
+ * stopped in the metrics segment (if any)
+ *
+ * @param game - main game struct
+ * @param status - reason the game stopped
+ */
+void publish_end(Game* game, enum ExitStatus status);
+
+/* Play entire game, blocking on each player in turn
+ * Stops after the read in progress once the game's stop flag is set
+ *
+ * @param game - main game struct
+ * @return NORMAL if the game completed, otherwise reason it stopped
+ */
+enum ExitStatus play_game(Game* game);
+
+#endif
@@ -0,0 +1,71 @@
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "metrics.h"
+
+/* Attach to (creating if need be) a metrics segment
+ *
+ * @param name - shared memory object name, eg "/2310metrics"
+ * @return mapped segment or NULL on failure
+ */
+Metrics* metrics_open(const char* name) {
+    int fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        return NULL;
+    }
+    // growing a new (empty) object zero fills it; racing hubs both do the
+    // same, and an existing segment is left alone
+    struct stat info;
+    if (fstat(fd, &info) || (info.st_size < (off_t) sizeof(Metrics)
+            && ftruncate(fd, sizeof(Metrics)))) {
+        close(fd);
+        return NULL;
+    }
+    Metrics* metrics = mmap(NULL, sizeof(Metrics), PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    close(fd);
+    if (metrics == MAP_FAILED) {
+        return NULL;
+    }
+    memcpy(metrics->magic, METRICS_MAGIC, sizeof(metrics->magic));
+    return metrics;
+}
+
+/* Detach from a metrics segment, leaving it for other hubs and 2310top
+ *
+ * @param metrics - segment from metrics_open
+ */
+void metrics_close(Metrics* metrics) {
+    munmap(metrics, sizeof(Metrics));
+}
+
+/* Attach to an existing metrics segment without changing it
+ *
+ * @param name - shared memory object name
+ * @return mapped segment or NULL if it does not exist
+ */
+const Metrics* metrics_attach(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) || info.st_size < (off_t) sizeof(Metrics)) {
+        close(fd);
+        return NULL;
+    }
+    const Metrics* metrics = mmap(NULL, sizeof(Metrics), PROT_READ,
+            MAP_SHARED, fd, 0);
+    close(fd);
+    if (metrics == MAP_FAILED) {
+        return NULL;
+    }
+    if (memcmp(metrics->magic, METRICS_MAGIC, sizeof(metrics->magic))) {
+        munmap((void*) metrics, sizeof(Metrics));
+        return NULL;
+    }
+    return metrics;
+}
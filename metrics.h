@@ -0,0 +1,63 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+
+#define METRICS_ENV "METRICS_2310" // shared memory name to count into
+#define METRICS_MAGIC "2310MET1"
+#define METRICS_SEATS 16 // seats with their own message counters
+
+// Counters shared by every hub using the same name, only ever increased
+// (except currentRound) with relaxed atomic adds
+typedef struct {
+    char magic[8];
+    uint64_t gamesStarted;
+    uint64_t gamesCompleted;
+    uint64_t rounds; // rounds completed
+    uint64_t invalidExits; // games ended by an invalid message or card
+    uint64_t eofExits; // games ended by a player closing its pipe
+    uint64_t otherExits; // games ended any other way
+    uint64_t currentRound; // round being played by the latest active game
+    uint64_t messages[METRICS_SEATS]; // sent to and received from a seat
+    uint64_t bytes[METRICS_SEATS];
+} Metrics;
+
+/* Attach to (creating if need be) a metrics segment
+ *
+ * @param name - shared memory object name, eg "/2310metrics"
+ * @return mapped segment or NULL on failure
+ */
+Metrics* metrics_open(const char* name);
+
+/* Detach from a metrics segment, leaving it for other hubs and 2310top
+ *
+ * @param metrics - segment from metrics_open
+ */
+void metrics_close(Metrics* metrics);
+
+/* Attach to an existing metrics segment without changing it
+ *
+ * @param name - shared memory object name
+ * @return mapped segment or NULL if it does not exist
+ */
+const Metrics* metrics_attach(const char* name);
+
+/* Add to a counter
+ *
+ * @param counter - counter in a metrics segment
+ * @param amount - amount to add
+ */
+static inline void metrics_add(uint64_t* counter, uint64_t amount) {
+    __atomic_fetch_add(counter, amount, __ATOMIC_RELAXED);
+}
+
+/* Read a counter
+ *
+ * @param counter - counter in a metrics segment
+ * @return its value
+ */
+static inline uint64_t metrics_read(const uint64_t* counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+#endif
@@ -0,0 +1,196 @@
+#define _GNU_SOURCE // sched_setaffinity and F_SETPIPE_SZ are Linux only
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <sched.h>
+#include <fcntl.h>
+
+#include "placement.h"
+
+#define TOPOLOGY_PATH "/sys/devices/system/cpu/cpu%d/topology/%s"
+#define PATH_SIZE 80
+
+// Where a CPU sits in the machine
+typedef struct {
+    int cpu;
+    int package; // physical socket
+    int core; // core within the socket
+    int thread; // position among the core's SMT siblings
+} CpuInfo;
+
+/* Read one topology number for a CPU
+ *
+ * @param cpu - CPU to look up
+ * @param item - topology file, eg "core_id"
+ * @param fallback - value to use if the file cannot be read
+ * @return the number read or fallback
+ */
+static int read_topology(int cpu, const char* item, int fallback) {
+    char path[PATH_SIZE];
+    snprintf(path, sizeof(path), TOPOLOGY_PATH, cpu, item);
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return fallback;
+    }
+    int value;
+    if (fscanf(file, "%d", &value) != 1) {
+        value = fallback;
+    }
+    fclose(file);
+    return value;
+}
+
+/* Order CPUs so SMT siblings are next to each other
+ *
+ * @param a - first CpuInfo
+ * @param b - second CpuInfo
+ * @return negative, zero or positive as for qsort
+ */
+static int compare_smt(const void* a, const void* b) {
+    const CpuInfo* first = a;
+    const CpuInfo* second = b;
+    if (first->package != second->package) {
+        return first->package - second->package;
+    }
+    if (first->core != second->core) {
+        return first->core - second->core;
+    }
+    return first->cpu - second->cpu;
+}
+
+/* Order CPUs so one thread of every core comes before any second thread
+ *
+ * @param a - first CpuInfo
+ * @param b - second CpuInfo
+ * @return negative, zero or positive as for qsort
+ */
+static int compare_spread(const void* a, const void* b) {
+    const CpuInfo* first = a;
+    const CpuInfo* second = b;
+    if (first->thread != second->thread) {
+        return first->thread - second->thread;
+    }
+    return compare_smt(a, b);
+}
+
+/* Find the CPUs this process may run on, sorted with siblings together
+ *
+ * @param numCpus - pointer to store number of CPUs found into
+ * @return malloced array of numCpus CPUs or NULL if none could be found
+ */
+static CpuInfo* available_cpus(int* numCpus) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed)) {
+        return NULL;
+    }
+    CpuInfo* cpus = malloc(sizeof(CpuInfo) * CPU_COUNT(&allowed));
+    *numCpus = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            CpuInfo* info = &cpus[(*numCpus)++];
+            info->cpu = cpu;
+            // without topology every CPU is taken to be its own core
+            info->package = read_topology(cpu, "physical_package_id", 0);
+            info->core = read_topology(cpu, "core_id", cpu);
+        }
+    }
+    qsort(cpus, *numCpus, sizeof(CpuInfo), compare_smt);
+    for (int i = 0; i < *numCpus; i++) {
+        bool sibling = i > 0 && cpus[i].package == cpus[i - 1].package
+                && cpus[i].core == cpus[i - 1].core;
+        cpus[i].thread = sibling ? cpus[i - 1].thread + 1 : 0;
+    }
+    return cpus;
+}
+
+/* Parse a comma separated list of CPUs
+ *
+ * @param spec - the list
+ * @param numCpus - pointer to store number of CPUs in the list into
+ * @return malloced array of numCpus CPUs or NULL if the list is invalid
+ */
+static int* parse_cpu_list(const char* spec, int* numCpus) {
+    int* cpus = malloc(sizeof(int) * (strlen(spec) / 2 + 1));
+    *numCpus = 0;
+    const char* next = spec;
+    while (true) {
+        char* end;
+        long cpu = strtol(next, &end, 10);
+        if (end == next || cpu < 0 || cpu >= CPU_SETSIZE
+                || (*end != ',' && *end != '\0')) {
+            free(cpus);
+            return NULL;
+        }
+        cpus[(*numCpus)++] = cpu;
+        if (*end == '\0') {
+            return cpus;
+        }
+        next = end + 1;
+    }
+}
+
+/* Choose a CPU for each of a number of processes
+ * "smt" packs processes onto the sibling threads of one core before moving
+ * to the next, "spread" gives each process its own core while there are
+ * enough, and a comma separated list of CPUs is used in order
+ * CPUs are reused from the start once every one has been given out
+ *
+ * @param spec - placement to use
+ * @param numProcesses - number of CPUs to choose
+ * @return malloced array of numProcesses CPUs or NULL if spec is invalid
+ */
+int* plan_placement(const char* spec, int numProcesses) {
+    int numCpus;
+    int* order;
+    if (!strcmp(spec, "smt") || !strcmp(spec, "spread")) {
+        CpuInfo* cpus = available_cpus(&numCpus);
+        if (cpus == NULL || numCpus == 0) {
+            free(cpus);
+            return NULL;
+        }
+        if (!strcmp(spec, "spread")) {
+            qsort(cpus, numCpus, sizeof(CpuInfo), compare_spread);
+        }
+        order = malloc(sizeof(int) * numCpus);
+        for (int i = 0; i < numCpus; i++) {
+            order[i] = cpus[i].cpu;
+        }
+        free(cpus);
+    } else {
+        order = parse_cpu_list(spec, &numCpus);
+        if (order == NULL) {
+            return NULL;
+        }
+    }
+
+    int* placement = malloc(sizeof(int) * numProcesses);
+    for (int i = 0; i < numProcesses; i++) {
+        placement[i] = order[i % numCpus];
+    }
+    free(order);
+    return placement;
+}
+
+/* Restrict the calling process (and anything it later execs) to one CPU
+ *
+ * @param cpu - CPU to run on
+ * @return true if the CPU could not be chosen
+ */
+bool pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) != 0;
+}
+
+/* Resize a pipe so it holds at least a number of bytes
+ * The kernel rounds the size up to a whole page
+ *
+ * @param fd - either end of the pipe
+ * @param bytes - bytes the pipe must hold
+ * @return true if the pipe could not be resized
+ */
+bool size_pipe(int fd, int bytes) {
+    return fcntl(fd, F_SETPIPE_SZ, bytes) == -1;
+}
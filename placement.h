@@ -0,0 +1,36 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <stdbool.h>
+
+#define PLACEMENT_ENV "PLACEMENT_2310" // "smt", "spread" or a list of CPUs
+
+/* Choose a CPU for each of a number of processes
+ * "smt" packs processes onto the sibling threads of one core before moving
+ * to the next, "spread" gives each process its own core while there are
+ * enough, and a comma separated list of CPUs is used in order
+ * CPUs are reused from the start once every one has been given out
+ *
+ * @param spec - placement to use
+ * @param numProcesses - number of CPUs to choose
+ * @return malloced array of numProcesses CPUs or NULL if spec is invalid
+ */
+int* plan_placement(const char* spec, int numProcesses);
+
+/* Restrict the calling process (and anything it later execs) to one CPU
+ *
+ * @param cpu - CPU to run on
+ * @return true if the CPU could not be chosen
+ */
+bool pin_to_cpu(int cpu);
+
+/* Resize a pipe so it holds at least a number of bytes
+ * The kernel rounds the size up to a whole page
+ *
+ * @param fd - either end of the pipe
+ * @param bytes - bytes the pipe must hold
+ * @return true if the pipe could not be resized
+ */
+bool size_pipe(int fd, int bytes);
+
+#endif
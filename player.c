@@ -4,6 +4,8 @@
 #include <string.h>
 
 #include "player.h"
+#include "protocol.h"
+#include "trace.h"
 #include "util.h"
 
 /* quit the game after printing the correct error message
@@ -29,88 +31,44 @@ void quit_game(enum ExitStatus status) {
     exit(status);
 }
 
-/* Determine the type of message that was received
- * If it does not match a known type, returns INVALID_MESSAGE
- *
- * @param message - string containing message from hub
- * @return - type of message
- */
-enum HubMessage categorise_message(char* message) {
-    if (strncmp(message, "HAND", strlen("HAND")) == 0) {
-        return HAND;
-    } else if (strncmp(message, "NEWROUND", strlen("NEWROUND")) == 0) {
-        return NEW_ROUND;
-    } else if (strncmp(message, "PLAYED", strlen("PLAYED")) == 0) {
-        return PLAYED;
-    } else if (strncmp(message, "GAMEOVER", strlen("GAMEOVER")) == 0) {
-        return GAME_OVER;
-    } else {
-        return INVALID_MESSAGE;
-    }
-}
-
 /* Process a HAND message from the hub
- * Store the contents of message in the game struct
+ * The cards have already been decoded into the game's hand
  *
- * WARNING - game struct modified before entire message is parsed
+ * WARNING - game struct modified before entire message is checked
  *
- * @param message - message from hub (known to be HAND already)
+ * @param message - decoded message from hub (known to be HAND already)
  * @param game - main game struct
  * @return false if processing was successful, true otherwise
  */
-// 0 for success, 1 for failure
-bool process_hand_message(char* message, Game* game) {
-    message += strlen("HAND");
-
-    char* end;
-    int handSize = strtol(message, &end, 10);
-    if (handSize != game->turnsRemaining || *end != ',') {
+bool process_hand_message(Message* message, Game* game) {
+    if (game->dealt || message->number != game->turnsRemaining) {
         return true;
     }
-
-    for (int i = 0; i < handSize; i++) {
-        // skip over comma
-        message = end + 1;
-
-        if (message[0] != 'D' && message[0] != 'H' && message[0] != 'S'
-                && message[0] != 'C') {
-            return true;
-        }
-        game->hand[i].suit = message[0];
-
-        // finished with suit, move to rank
-        message++;
-        int rank = strtol(message, &end, RANK_BASE);
-        if (rank < MIN_RANK || rank > MAX_RANK ||
-                (i < handSize - 1 && *end != ',') ||
-                (i == handSize - 1 && *end != '\0')) {
-            return true;
-        }
-        game->hand[i].rank = rank;
-    }
+    game->dealt = true;
     return false;
 }
 
 /* Process a NEWROUND message from the hub
  * store the contents of message in the game struct
  *
- * @param message - message from hub (known to be NEWROUND already)
+ * @param message - decoded message from hub (known to be NEWROUND already)
  * @param game - main game struct
  * @return false if processing was successful, true otherwise
  */
-bool process_new_round_message(char* message, Game* game) {
-    message += strlen("NEWROUND");
+bool process_new_round_message(Message* message, Game* game) {
+    if (game->turnsRemaining == 0 || !game->dealt) {
+        return true;
+    }
 
-    if (game->turnsRemaining == 0) {
+    // the previous round (if any) must be over
+    if (game->leadPlayer != -1 && game->playerCount != game->numPlayers) {
         return true;
     }
 
-    char* end;
-    int leadPlayer = strtol(message, &end, 10);
-    if (leadPlayer >= game->numPlayers || *end) {
+    if (message->number >= game->numPlayers) {
         return true;
     }
-    game->leadPlayer = leadPlayer;
+    game->leadPlayer = message->number;
     
     // We know this is the first player of the round
     game->playerCount = 0;
@@ -120,48 +78,57 @@ bool process_new_round_message(char* message, Game* game) {
 /* Process a PLAYED message from the hub
  * store the contents of message in the game struct
  *
- * @param message - message from hub (known to be PLAYED already)
+ * @param message - decoded message from hub (known to be PLAYED already)
  * @param game - main game struct
  * @return false if processing was successful, true otherwise
  */
-bool process_played_message(char* message, Game* game) {
-    message += strlen("PLAYED");
-
-    char* end;
-    int playerNumber = strtol(message, &end, 10);
-    if (playerNumber != ((game->playerCount + game->leadPlayer) 
-            % game->numPlayers)
-            || *end != ',') {
-        return true;
+bool process_played_message(Message* message, Game* game) {
+    if (game->leadPlayer == -1 || game->playerCount == game->numPlayers) {
+        return true; // no round in progress
     }
-
-    message = end + 1;
-    char suit = message[0];
-    message++;
-    int rank = strtol(message, &end, RANK_BASE);
-    if ((suit != 'D' && suit != 'H' && suit != 'S' && suit != 'C') ||
-            rank < MIN_RANK || rank > MAX_RANK || *end != '\0') {
+    int playerNumber = message->number;
+    if (playerNumber != ((game->playerCount + game->leadPlayer) 
+            % game->numPlayers)) {
         return true;
     }
 
-    game->turn[playerNumber].suit = suit;
-    game->turn[playerNumber].rank = rank;
+    game->turn[playerNumber] = message->card;
     game->playerCount++;
     return false;
 }
 
-/* Process a GAMEOVER message from the hub
- * 
- * @param message - message from hub (known to be GAMEOVER already)
+/* Choose a card, reusing the decision made last time the same situation
+ * arose if the cache is enabled
+ *
  * @param game - main game struct
- * @return false if processing was successful, true otherwise
+ * @return index of chosen card
  */
-bool process_game_over_message(char* message, Game* game) {
-    message += strlen("GAMEOVER");
-    if (*message != '\0') {
-        return true;
+static int decide(Game* game) {
+    if (game->cache == NULL) {
+        return choose_card(game);
     }
-    return false;
+    Situation situation;
+    situation.hand = 0;
+    for (int i = 0; i < game->handSize; i++) {
+        if (game->hand[i] != NO_CARD) {
+            situation.hand |= (uint64_t) 1 << game->hand[i];
+        }
+    }
+    situation.lead = game->leadPlayer == game->playerID ? LEADING :
+            card_suit(game->turn[game->leadPlayer]);
+    situation.flags = decision_flags(game);
+
+    Card card;
+    if (!cache_lookup(game->cache, &situation, &card)) {
+        for (int i = 0; i < game->handSize; i++) {
+            if (game->hand[i] == card) {
+                return i;
+            }
+        }
+    }
+    int chosenCard = choose_card(game);
+    cache_insert(game->cache, &situation, game->hand[chosenCard]);
+    return chosenCard;
 }
 
 /* play a turn to the hub
@@ -170,58 +137,73 @@ bool process_game_over_message(char* message, Game* game) {
  * @param game - main game struct
  */
 void play_turn(Game* game) {
-    int chosenCard = choose_card(game);
-    printf("PLAY%c%x\n", game->hand[chosenCard].suit,
-            game->hand[chosenCard].rank);
-    fflush(stdout);
+    int chosenCard = decide(game);
+    trace_event(TRACE_DECISION, 0, NO_SEAT, chosenCard,
+            game->hand[chosenCard]);
+    char buffer[MESSAGE_SIZE];
+    if (game->tag != INVALID) {
+        fprintf(game->output, "%d ", game->tag);
+    }
+    fwrite(buffer, 1, encode_play(buffer, game->hand[chosenCard]),
+            game->output);
+    fflush(game->output);
+    trace_event(TRACE_SENT, PLAY, NO_SEAT, 0, game->hand[chosenCard]);
 
     game->turn[game->playerID] = game->hand[chosenCard];
     // Disable card in hand
-    game->hand[chosenCard].rank = INVALID;
+    game->hand[chosenCard] = NO_CARD;
     game->playerCount++;
 }
 
 /* Determine which player won a round and give them points and D cards
  *
  * @param game - main game struct
+ * @return player who won the round
  */
-void find_winner(Game* game) {
-    char leadSuit = game->turn[game->leadPlayer].suit;
+int find_winner(Game* game) {
+    Suit leadSuit = card_suit(game->turn[game->leadPlayer]);
     int dPlayed = 0;
 
     int winnerIndex = game->leadPlayer;
-    int maxRank = game->turn[game->leadPlayer].rank;
+    int maxRank = card_rank(game->turn[game->leadPlayer]);
 
     for (int i = 0; i < game->numPlayers; i++) {
-        if (game->turn[i].suit == leadSuit && game->turn[i].rank > maxRank) {
-            maxRank = game->turn[i].rank;
+        if (card_suit(game->turn[i]) == leadSuit &&
+                card_rank(game->turn[i]) > maxRank) {
+            maxRank = card_rank(game->turn[i]);
             winnerIndex = i;
         }
-        if (game->turn[i].suit == 'D') {
+        if (card_suit(game->turn[i]) == PENALTY_SUIT) {
             dPlayed++;
         }
     }
 
     game->playerPoints[winnerIndex]++;
     game->dWon[winnerIndex] += dPlayed;
+    return winnerIndex;
 }
 
-/* Print message to stderr at end of each round
+/* Print message to stderr at end of each round if enabled with
+ * ROUND_LOG_ENV
  * Also handle end of round game state updates
  *
  * @param - main game struct
  */
 void end_of_round(Game* game) {
-    fprintf(stderr, "Lead player=%d: ", game->leadPlayer);
-
-    for (int i = 0; i < game->numPlayers; i++) {
-        int playerNum = (i + game->leadPlayer) % game->numPlayers;
-        fprintf(stderr, "%c.%x", game->turn[playerNum].suit,
-                game->turn[playerNum].rank);
-        fprintf(stderr, "%c", i == game->numPlayers - 1 ? '\n' : ' ');
+    if (game->logRounds) {
+        fprintf(stderr, "Lead player=%d: ", game->leadPlayer);
+
+        for (int i = 0; i < game->numPlayers; i++) {
+            int playerNum = (i + game->leadPlayer) % game->numPlayers;
+            fprintf(stderr, "%c.%x",
+                    suit_char(card_suit(game->turn[playerNum])),
+                    card_rank(game->turn[playerNum]));
+            fprintf(stderr, "%c", i == game->numPlayers - 1 ? '\n' : ' ');
+        }
     }
 
-    find_winner(game);
+    int winner = find_winner(game);
+    trace_round(game->leadPlayer, winner, game->turn[winner]);
     game->turnsRemaining--;
 }
 
@@ -236,28 +218,118 @@ void end_of_round(Game* game) {
 Game setup_game(int numPlayers, int playerID, int threshold, int handSize) {
     Game game;
 
-    game.numPlayers = numPlayers;
-    game.playerID = playerID;
-    game.threshold = threshold;
-    game.handSize = handSize;
-    game.turnsRemaining = handSize;
+    arena_init(&game.arena);
+    game.output = stdout;
+    game.tag = INVALID;
+    game.cache = NULL;
+    game.logRounds = false;
+    reset_game(&game, numPlayers, playerID, threshold, handSize);
+
+    return game;
+}
+
+/* Reuse a game struct for a new game, keeping its output, tag, cache and
+ * logging
+ * The per-round data (cards played, points and D cards won) is laid out
+ * together at the front of the game's arena, ahead of the hand
+ *
+ * @param game - main game struct to reset
+ * @param numPlayers - number of players in the game
+ * @param playerID - ID of this player
+ * @param threshold - threshold of diamond cards
+ * @param handSize - number of cards in initial hand
+ */
+void reset_game(Game* game, int numPlayers, int playerID, int threshold,
+        int handSize) {
+    arena_reset(&game->arena, ARENA_SIZE(sizeof(Card) * numPlayers)
+            + 2 * ARENA_SIZE(sizeof(int) * numPlayers)
+            + ARENA_SIZE(sizeof(Card) * handSize));
+    game->turn = arena_alloc(&game->arena, sizeof(Card) * numPlayers);
+    game->playerPoints = arena_alloc(&game->arena, sizeof(int) * numPlayers);
+    game->dWon = arena_alloc(&game->arena, sizeof(int) * numPlayers);
+    game->hand = arena_alloc(&game->arena, sizeof(Card) * handSize);
+
+    game->numPlayers = numPlayers;
+    game->playerID = playerID;
+    game->threshold = threshold;
+    game->handSize = handSize;
+    game->turnsRemaining = handSize;
 
-    game.hand = malloc(sizeof(Card) * handSize);
     for (int i = 0; i < handSize; i++) {
-        game.hand[i].rank = INVALID;
+        game->hand[i] = NO_CARD;
     }
 
-    game.leadPlayer = -1; // not a valid player yet
-    game.turn = malloc(sizeof(Card) * numPlayers);
-
-    game.playerPoints = malloc(sizeof(int) * numPlayers);
-    game.dWon = malloc(sizeof(int) * numPlayers);
+    game->leadPlayer = -1; // not a valid player yet
+    game->playerCount = 0;
+    game->dealt = false;
     for (int i = 0; i < numPlayers; i++) {
-        game.playerPoints[i] = 0;
-        game.dWon[i] = 0;
+        game->playerPoints[i] = 0;
+        game->dWon[i] = 0;
     }
+}
 
-    return game;
+/* Free everything allocated by setup_game
+ *
+ * @param game - main game struct
+ */
+void free_game(Game* game) {
+    arena_free(&game->arena);
+}
+
+/* Handle a single message from the hub, playing a card if it is this
+ * player's turn
+ *
+ * @param game - main game struct
+ * @param line - message received, without its newline
+ * @param gameOver - set to true once GAMEOVER is received
+ * @return NORMAL or INV_MESS if the message was invalid
+ */
+enum ExitStatus process_message(Game* game, const char* line,
+        bool* gameOver) {
+    Message decoded;
+    // once dealt, a second HAND must not overwrite the hand
+    enum MessageType type = decode_message(line, &decoded,
+            game->dealt ? NULL : game->hand, game->dealt ? 0 : game->handSize);
+    trace_event(TRACE_RECEIVED, type, NO_SEAT, decoded.number, decoded.card);
+    switch (type) {
+        case HAND:
+            if (process_hand_message(&decoded, game)) {
+                return INV_MESS;
+            }
+            break;
+        case NEW_ROUND:
+            if (process_new_round_message(&decoded, game)) {
+                return INV_MESS;
+            }
+            if (game->leadPlayer == game->playerID) {
+                play_turn(game);
+            }
+            break;
+        case PLAYED:
+            if (process_played_message(&decoded, game)) {
+                return INV_MESS;
+            }
+            if (game->playerCount == game->numPlayers) {
+                end_of_round(game);
+            } else if ((game->leadPlayer + game->playerCount) 
+                    % game->numPlayers == game->playerID) {
+                play_turn(game);
+                if (game->playerCount == game->numPlayers) {
+                    end_of_round(game);
+                }
+            }
+            break;
+        case GAME_OVER:
+            if (game->cache != NULL) {
+                trace_cache(game->cache->hits, game->cache->misses);
+            }
+            *gameOver = true;
+            break;
+        case PLAY:
+        case INVALID_MESSAGE:
+            return INV_MESS;
+    }
+    return NORMAL;
 }
 
 /* Play a complete game
@@ -275,76 +347,103 @@ void play_game(Game* game) {
         if (length == 0 && feof(stdin)) {
             quit_game(END_OF_FILE);
         }
-        //fprintf(stderr, "%s\n", message);
-        switch(categorise_message(message)) {
-            case HAND:
-                if (process_hand_message(message, game)) {
-                    quit_game(INV_MESS);
-                }
-                break;
-            case NEW_ROUND:
-                if (process_new_round_message(message, game)) {
-                    quit_game(INV_MESS);
-                }
-                if (game->leadPlayer == game->playerID) {
-                    play_turn(game);
-                }
-                break;
-            case PLAYED:
-                if (process_played_message(message, game)) {
-                    quit_game(INV_MESS);
-                }
-                if (game->playerCount == game->numPlayers) {
-                    end_of_round(game);
-                } else if ((game->leadPlayer + game->playerCount) 
-                        % game->numPlayers == game->playerID) {
-                    play_turn(game);
-                    if (game->playerCount == game->numPlayers) {
-                        end_of_round(game);
-                    }
-                }
-                break;
-            case GAME_OVER:
-                if (process_game_over_message(message, game)) {
-                    quit_game(INV_MESS);
-                }
-                gameOver = true;
-                break;
-            case INVALID_MESSAGE:
-                quit_game(INV_MESS);
+        enum ExitStatus status = process_message(game, message, &gameOver);
+        free(message);
+        if (status != NORMAL) {
+            quit_game(status);
         }
     }
 }
 
-int main(int argc, char** argv) {
-    if (argc != NUM_ARGS) {
-        quit_game(USAGE);
-    }
-    // parse command line arguments
-    char* end;
-    int numPlayers = strtol(argv[1], &end, 10);
-    if (numPlayers < 2 || *end) {
-        quit_game(INV_PLAYERS);
-    }
-    int playerID = strtol(argv[2], &end, 10);
-    if (playerID < 0 || playerID >= numPlayers || *end) {
-        quit_game(INV_POSITION);
-    }
-    int threshold = strtol(argv[3], &end, 10);
-    if (threshold < 2 || *end) {
-        quit_game(INV_THRESHOLD);
+/* Set up the game a "GAME players seat threshold hand" line asks for,
+ * reusing the slot's arena if it has held a game before
+ *
+ * @param slot - slot for the game's id
+ * @param id - the game's id
+ * @param args - text after MUX_OPEN
+ * @param cache - decision cache shared by every game, or NULL
+ * @param logRounds - print each round to stderr
+ * @return true if the arguments are invalid
+ */
+static bool open_game(GameSlot* slot, int id, const char* args,
+        DecisionCache* cache, bool logRounds) {
+    int numPlayers, playerID, threshold, handSize, length;
+    if (sscanf(args, " %d %d %d %d%n", &numPlayers, &playerID, &threshold,
+            &handSize, &length) != 4 || args[length] || numPlayers < 2
+            || playerID < 0 || playerID >= numPlayers || threshold < 2
+            || handSize < 1) {
+        return true;
     }
-    int handSize = strtol(argv[4], &end, 10);
-    if (handSize < 1 || *end) {
-        quit_game(INV_HAND);
+    if (slot->started) {
+        reset_game(&slot->game, numPlayers, playerID, threshold, handSize);
+    } else {
+        slot->game = setup_game(numPlayers, playerID, threshold, handSize);
+        slot->started = true;
     }
+    slot->game.tag = id;
+    slot->game.cache = cache;
+    slot->game.logRounds = logRounds;
+    slot->active = true;
+    return false;
+}
+
+/* Serve many games at once, reading tagged messages from stdin until EOF
+ * A problem with one game only ends that game
+ *
+ * @param cache - decision cache shared by every game, or NULL
+ * @param logRounds - print each round to stderr
+ */
+void serve_games(DecisionCache* cache, bool logRounds) {
+    GameSlot* slots = NULL;
+    int numSlots = 0;
+    while (true) {
+        char* line;
+        int length = read_line(stdin, &line);
+        if (length == 0 && feof(stdin)) {
+            free(line);
+            break;
+        }
+        char* message;
+        long id = strtol(line, &message, 10);
+        if (message == line || *message++ != ' ' || id < 0
+                || id >= MUX_MAX_GAMES) {
+            free(line); // cannot be answered without an id
+            continue;
+        }
+        if (id >= numSlots) {
+            slots = realloc(slots, sizeof(GameSlot) * (id + 1));
+            memset(slots + numSlots, 0,
+                    sizeof(GameSlot) * (id + 1 - numSlots));
+            numSlots = id + 1;
+        }
 
-    printf("@");
-    fflush(stdout);
+        GameSlot* slot = &slots[id];
+        bool ended = false;
+        if (strncmp(message, MUX_OPEN, strlen(MUX_OPEN)) == 0) {
+            ended = slot->active || open_game(slot, id,
+                    message + strlen(MUX_OPEN), cache, logRounds);
+            if (!ended) {
+                printf("%ld @\n", id);
+            }
+        } else if (slot->active) {
+            bool gameOver = false;
+            ended = process_message(&slot->game, message, &gameOver)
+                    != NORMAL || gameOver;
+        }
+        if (ended) {
+            slot->active = false;
+            printf("%ld %s\n", id, MUX_CLOSE);
+        }
+        fflush(stdout);
+        free(line);
+    }
 
-    Game game = setup_game(numPlayers, playerID, threshold, handSize);
-    play_game(&game);
-    quit_game(NORMAL);
+    for (int i = 0; i < numSlots; i++) {
+        if (slots[i].started) {
+            free_game(&slots[i].game);
+        }
+    }
+    free(slots);
 }
 
 /* Find the index corresponding to the highest card in the players
@@ -354,15 +453,16 @@ int main(int argc, char** argv) {
  * @param suit - suit to look for
  * @return index of highest card matching suit or -1 if no card with suit
  */
-int find_highest_suit(Game* game, char suit) {
+int find_highest_suit(Game* game, Suit suit) {
     int maxIndex = INVALID;
     int maxRank = MIN_RANK - 1;
 
+    // played cards are NO_CARD, whose suit never matches
     for (int i = 0; i < game->handSize; i++) {
-        if (game->hand[i].rank != INVALID && game->hand[i].suit == suit) {
-            if (game->hand[i].rank > maxRank) {
+        if (card_suit(game->hand[i]) == suit) {
+            if (card_rank(game->hand[i]) > maxRank) {
                 maxIndex = i;
-                maxRank = game->hand[i].rank;
+                maxRank = card_rank(game->hand[i]);
             }
         }
     }
@@ -377,14 +477,14 @@ int find_highest_suit(Game* game, char suit) {
  * @param suit - suit to look for
  * @return index of lowest card matching suit or -1 if no card with suit
  */
-int find_lowest_suit(Game* game, char suit) {
+int find_lowest_suit(Game* game, Suit suit) {
     int minIndex = INVALID;
     int minRank = MAX_RANK + 1;
     for (int i = 0; i < game->handSize; i++) {
-        if (game->hand[i].rank != INVALID && game->hand[i].suit == suit) {
-            if (game->hand[i].rank < minRank) {
+        if (card_suit(game->hand[i]) == suit) {
+            if (card_rank(game->hand[i]) < minRank) {
                 minIndex = i;
-                minRank = game->hand[i].rank;
+                minRank = card_rank(game->hand[i]);
             }
         }
     }
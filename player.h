@@ -1,12 +1,17 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "arena.h"
+#include "cache.h"
+#include "card.h"
+#include "protocol.h"
+
 #define INVALID -1
-#define NUM_SUITS 4
-#define RANK_BASE 16
-#define MIN_RANK 0x0 // lowest rank card
-#define MAX_RANK 0xf // Highest rank card
 #define NUM_ARGS 5
+#define ROUND_LOG_ENV "ROUND_LOG_2310" // print each round to stderr if set
 
 // Enum for all player exit statuses
 enum ExitStatus {
@@ -20,36 +25,123 @@ enum ExitStatus {
     END_OF_FILE = 7
 };
 
-// Stores a card
-typedef struct {
-    char suit;
-    int rank; // -1 for invalid card
-} Card;
-
-// Categories of messages from hub
-enum HubMessage {
-    HAND,
-    NEW_ROUND,
-    PLAYED,
-    GAME_OVER,
-    INVALID_MESSAGE
-};
-
 // Stores all player information and game state
 typedef struct {
+    Arena arena; // holds the hand and per-round data
     int numPlayers;
     int playerID;
     int threshold;
     int handSize;
     int turnsRemaining;
-    Card* hand;
+    bool dealt; // HAND has been received
+    Card* hand; // NO_CARD once played
     int leadPlayer;
     Card* turn;
     int* playerPoints;
     int* dWon;
     int playerCount;
+    FILE* output; // where PLAY messages are written
+    int tag; // game id PLAY messages are prefixed with, or INVALID
+    DecisionCache* cache; // decisions already made, or NULL
+    bool logRounds; // print each round to stderr
 } Game;
 
+// One game id of a player serving many games
+typedef struct {
+    Game game;
+    bool started; // game has been set up, so its arena can be reused
+    bool active; // between MUX_OPEN and MUX_CLOSE
+} GameSlot;
+
+/* quit the game after printing the correct error message
+ *
+ * @param status - the exit status to use
+ */
+void quit_game(enum ExitStatus status);
+
+/* Process a HAND message from the hub
+ * The cards have already been decoded into the game's hand
+ *
+ * @param message - decoded message from hub (known to be HAND already)
+ * @param game - main game struct
+ * @return false if processing was successful, true otherwise
+ */
+bool process_hand_message(Message* message, Game* game);
+
+/* Process a NEWROUND message from the hub
+ * store the contents of message in the game struct
+ *
+ * @param message - decoded message from hub (known to be NEWROUND already)
+ * @param game - main game struct
+ * @return false if processing was successful, true otherwise
+ */
+bool process_new_round_message(Message* message, Game* game);
+
+/* Process a PLAYED message from the hub
+ * store the contents of message in the game struct
+ *
+ * @param message - decoded message from hub (known to be PLAYED already)
+ * @param game - main game struct
+ * @return false if processing was successful, true otherwise
+ */
+bool process_played_message(Message* message, Game* game);
+
+/* Set up a new game struct based on command line argument values
+ *
+ * @param numPlayers - number of players in the game
+ * @param playerID - ID of this player
+ * @param threshold - threshold of diamond cards
+ * @param handSize - number of cards in initial hand
+ * @return newly populated game struct
+ */
+Game setup_game(int numPlayers, int playerID, int threshold, int handSize);
+
+/* Free everything allocated by setup_game
+ *
+ * @param game - main game struct
+ */
+void free_game(Game* game);
+
+/* Reuse a game struct for a new game, keeping its output, tag, cache and
+ * logging
+ * The per-round data (cards played, points and D cards won) is laid out
+ * together at the front of the game's arena, ahead of the hand
+ *
+ * @param game - main game struct to reset
+ * @param numPlayers - number of players in the game
+ * @param playerID - ID of this player
+ * @param threshold - threshold of diamond cards
+ * @param handSize - number of cards in initial hand
+ */
+void reset_game(Game* game, int numPlayers, int playerID, int threshold,
+        int handSize);
+
+/* Handle a single message from the hub, playing a card if it is this
+ * player's turn
+ *
+ * @param game - main game struct
+ * @param line - message received, without its newline
+ * @param gameOver - set to true once GAMEOVER is received
+ * @return NORMAL or INV_MESS if the message was invalid
+ */
+enum ExitStatus process_message(Game* game, const char* line,
+        bool* gameOver);
+
+/* Play a complete game, reading messages from stdin
+ *
+ * Will exit the game if EOF is received prematurely or a message is invalid
+ *
+ * @param game - main game struct
+ */
+void play_game(Game* game);
+
+/* Serve many games at once, reading tagged messages from stdin until EOF
+ * A problem with one game only ends that game
+ *
+ * @param cache - decision cache shared by every game, or NULL
+ * @param logRounds - print each round to stderr
+ */
+void serve_games(DecisionCache* cache, bool logRounds);
 
 /* Choose a card to play and return the index of its in the players hand
  * To be used by each player for their strategy
@@ -59,6 +151,20 @@ typedef struct {
  */
 int choose_card(Game* game);
 
+/* Get the strategy specific part of a decision's situation, which
+ * together with the hand and lead suit fully decides choose_card
+ *
+ * @param game - main game struct
+ * @return small flags value
+ */
+int decision_flags(Game* game);
+
+/* Identify the strategy and its parameters, for persisted decision caches
+ *
+ * @return identifier, at most STRATEGY_ID_SIZE - 1 chars
+ */
+const char* strategy_id(void);
+
 /* Find the index corresponding to the highest card in the players
  * hand that belongs to the specific suit
  *
@@ -66,7 +172,7 @@ int choose_card(Game* game);
  * @param suit - suit to look for
  * @return index of highest card matching suit or -1 if no card with suit
  */
-int find_highest_suit(Game* game, char suit);
+int find_highest_suit(Game* game, Suit suit);
 
 /* Find the index corresponding to the lowest card in the players
  * hand that belongs to the specific suit
@@ -75,6 +181,6 @@ int find_highest_suit(Game* game, char suit);
  * @param suit - suit to look for
  * @return index of lowest card matching suit or -1 if no card with suit
  */
-int find_lowest_suit(Game* game, char suit);
+int find_lowest_suit(Game* game, Suit suit);
 
 #endif
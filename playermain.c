@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "player.h"
+#include "trace.h"
+
+/* Create the decision cache if CACHE_ENV asks for one, loading it from
+ * this strategy's file if there is one
+ *
+ * @param cacheFile - buffer of PATH_MAX chars to store the file name in
+ * @return the cache, or NULL if caching is off
+ */
+static DecisionCache* open_cache(char* cacheFile) {
+    // each strategy persists its cache in its own file, named after it
+    char* cachePrefix = getenv(CACHE_ENV);
+    if (cachePrefix == NULL) {
+        return NULL;
+    }
+    snprintf(cacheFile, PATH_MAX, "%s.%.*s", cachePrefix,
+            (int) strcspn(strategy_id(), " "), strategy_id());
+    return cache_create(strategy_id(), *cachePrefix ? cacheFile : NULL);
+}
+
+/* Save the decision cache if CACHE_ENV names where to
+ *
+ * @param cache - the cache, or NULL if caching is off
+ * @param cacheFile - file name from open_cache
+ */
+static void save_cache(DecisionCache* cache, char* cacheFile) {
+    char* cachePrefix = getenv(CACHE_ENV);
+    if (cache != NULL && *cachePrefix) {
+        cache_save(cache, cacheFile);
+    }
+}
+
+int main(int argc, char** argv) {
+    char cacheFile[PATH_MAX];
+    if (argc == 2 && strcmp(argv[1], MUX_ARG) == 0) {
+        DecisionCache* cache = open_cache(cacheFile);
+        serve_games(cache, getenv(ROUND_LOG_ENV) != NULL);
+        save_cache(cache, cacheFile);
+        quit_game(NORMAL);
+    }
+    if (argc != NUM_ARGS) {
+        quit_game(USAGE);
+    }
+    // parse command line arguments
+    char* end;
+    int numPlayers = strtol(argv[1], &end, 10);
+    if (numPlayers < 2 || *end) {
+        quit_game(INV_PLAYERS);
+    }
+    int playerID = strtol(argv[2], &end, 10);
+    if (playerID < 0 || playerID >= numPlayers || *end) {
+        quit_game(INV_POSITION);
+    }
+    int threshold = strtol(argv[3], &end, 10);
+    if (threshold < 2 || *end) {
+        quit_game(INV_THRESHOLD);
+    }
+    int handSize = strtol(argv[4], &end, 10);
+    if (handSize < 1 || *end) {
+        quit_game(INV_HAND);
+    }
+
+    printf("@");
+    fflush(stdout);
+
+    trace_start(playerID);
+    Game game = setup_game(numPlayers, playerID, threshold, handSize);
+    game.logRounds = getenv(ROUND_LOG_ENV) != NULL;
+    game.cache = open_cache(cacheFile);
+    play_game(&game);
+    save_cache(game.cache, cacheFile);
+    quit_game(NORMAL);
+}
@@ -0,0 +1,218 @@
+#include <string.h>
+#include <stdbool.h>
+
+#include "protocol.h"
+
+#define MAX_NUMBER 99999999 // larger numbers are rejected, avoiding overflow
+#define MAX_DIGITS 10 // digits in the largest int
+
+/* Write a non-negative decimal number into a buffer
+ *
+ * @param buffer - buffer to write to
+ * @param number - number to write
+ * @return number of chars written
+ */
+static int encode_number(char* buffer, int number) {
+    char digits[MAX_DIGITS];
+    int count = 0;
+    do {
+        digits[count++] = '0' + number % 10;
+        number /= 10;
+    } while (number > 0);
+    for (int i = 0; i < count; i++) {
+        buffer[i] = digits[count - 1 - i];
+    }
+    return count;
+}
+
+/* Write the two character text form of a card into a buffer
+ * The null terminator card_to_text adds is overwritten by whatever follows
+ *
+ * @param buffer - buffer to write to
+ * @param card - card to write
+ * @return number of chars written
+ */
+static int encode_card(char* buffer, Card card) {
+    card_to_text(card, buffer);
+    return CARD_TEXT_SIZE - 1;
+}
+
+/* Encode a HAND message
+ *
+ * @param buffer - buffer of at least HAND_MESSAGE_SIZE(numCards) chars
+ * @param cards - cards in the hand
+ * @param numCards - number of cards in the hand
+ * @return length of encoded message, including newline
+ */
+int encode_hand(char* buffer, const Card* cards, int numCards) {
+    int length = strlen("HAND");
+    memcpy(buffer, "HAND", length);
+    length += encode_number(buffer + length, numCards);
+    for (int i = 0; i < numCards; i++) {
+        buffer[length++] = ',';
+        length += encode_card(buffer + length, cards[i]);
+    }
+    buffer[length++] = '\n';
+    return length;
+}
+
+/* Encode a NEWROUND message
+ *
+ * @param buffer - buffer of at least MESSAGE_SIZE chars
+ * @param leadPlayer - player leading the round
+ * @return length of encoded message, including newline
+ */
+int encode_new_round(char* buffer, int leadPlayer) {
+    int length = strlen("NEWROUND");
+    memcpy(buffer, "NEWROUND", length);
+    length += encode_number(buffer + length, leadPlayer);
+    buffer[length++] = '\n';
+    return length;
+}
+
+/* Encode a PLAYED message
+ *
+ * @param buffer - buffer of at least MESSAGE_SIZE chars
+ * @param player - player who played the card
+ * @param card - card that was played
+ * @return length of encoded message, including newline
+ */
+int encode_played(char* buffer, int player, Card card) {
+    int length = strlen("PLAYED");
+    memcpy(buffer, "PLAYED", length);
+    length += encode_number(buffer + length, player);
+    buffer[length++] = ',';
+    length += encode_card(buffer + length, card);
+    buffer[length++] = '\n';
+    return length;
+}
+
+/* Encode a GAMEOVER message
+ *
+ * @param buffer - buffer of at least MESSAGE_SIZE chars
+ * @return length of encoded message, including newline
+ */
+int encode_game_over(char* buffer) {
+    int length = strlen("GAMEOVER\n");
+    memcpy(buffer, "GAMEOVER\n", length);
+    return length;
+}
+
+/* Encode a PLAY message
+ *
+ * @param buffer - buffer of at least MESSAGE_SIZE chars
+ * @param card - card being played
+ * @return length of encoded message, including newline
+ */
+int encode_play(char* buffer, Card card) {
+    int length = strlen("PLAY");
+    memcpy(buffer, "PLAY", length);
+    length += encode_card(buffer + length, card);
+    buffer[length++] = '\n';
+    return length;
+}
+
+/* Parse an unsigned decimal number, advancing past it
+ *
+ * @param text - pointer to text to parse, updated to point after number
+ * @param number - pointer to store number in
+ * @return false if a number was parsed, true otherwise
+ */
+static bool decode_number(const char** text, int* number) {
+    const char* digits = *text;
+    if (*digits < '0' || *digits > '9') {
+        return true;
+    }
+    int value = 0;
+    while (*digits >= '0' && *digits <= '9') {
+        value = value * 10 + (*digits++ - '0');
+        if (value > MAX_NUMBER) {
+            return true;
+        }
+    }
+    *number = value;
+    *text = digits;
+    return false;
+}
+
+/* Classify and parse a message in a single pass
+ * Numbers must be unsigned decimal and cards a suit followed by one lower
+ * case hex digit, with nothing else on the line
+ *
+ * @param line - null terminated message, without newline
+ * @param message - pointer to store decoded message in
+ * @param hand - where to store the cards of a HAND message
+ * @param handCapacity - number of cards hand can hold
+ * @return type of message, INVALID_MESSAGE if it did not parse
+ */
+enum MessageType decode_message(const char* line, Message* message,
+        Card* hand, int handCapacity) {
+    message->type = INVALID_MESSAGE;
+    message->number = 0;
+    message->card = NO_CARD;
+    const char* next = line;
+    enum MessageType type;
+    switch (line[0]) {
+        case 'H':
+            if (strncmp(line, "HAND", strlen("HAND")) != 0) {
+                return INVALID_MESSAGE;
+            }
+            next += strlen("HAND");
+            if (decode_number(&next, &message->number) ||
+                    message->number > handCapacity) {
+                return INVALID_MESSAGE;
+            }
+            for (int i = 0; i < message->number; i++) {
+                if (*next != ',' || parse_card(next + 1, &hand[i])) {
+                    return INVALID_MESSAGE;
+                }
+                next += 3;
+            }
+            type = HAND;
+            break;
+        case 'N':
+            if (strncmp(line, "NEWROUND", strlen("NEWROUND")) != 0) {
+                return INVALID_MESSAGE;
+            }
+            next += strlen("NEWROUND");
+            if (decode_number(&next, &message->number)) {
+                return INVALID_MESSAGE;
+            }
+            type = NEW_ROUND;
+            break;
+        case 'P':
+            if (strncmp(line, "PLAYED", strlen("PLAYED")) == 0) {
+                next += strlen("PLAYED");
+                if (decode_number(&next, &message->number) ||
+                        *next != ',' || parse_card(next + 1, &message->card)) {
+                    return INVALID_MESSAGE;
+                }
+                next += 3;
+                type = PLAYED;
+            } else if (strncmp(line, "PLAY", strlen("PLAY")) == 0) {
+                next += strlen("PLAY");
+                if (parse_card(next, &message->card)) {
+                    return INVALID_MESSAGE;
+                }
+                next += 2;
+                type = PLAY;
+            } else {
+                return INVALID_MESSAGE;
+            }
+            break;
+        case 'G':
+            if (strncmp(line, "GAMEOVER", strlen("GAMEOVER")) != 0) {
+                return INVALID_MESSAGE;
+            }
+            next += strlen("GAMEOVER");
+            type = GAME_OVER;
+            break;
+        default:
+            return INVALID_MESSAGE;
+    }
+    if (*next != '\0') {
+        return INVALID_MESSAGE;
+    }
+    message->type = type;
+    return type;
+}
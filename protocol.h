@@ -0,0 +1,92 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "card.h"
+
+#define MESSAGE_SIZE 32 // fits any message other than HAND, with newline
+// Space needed to encode a HAND message of numCards cards, with newline
+#define HAND_MESSAGE_SIZE(numCards) (MESSAGE_SIZE + 3 * (numCards))
+
+// A player started with MUX_ARG serves many games over its stdin and stdout,
+// every line being prefixed with a game id and a space. The hub starts a
+// game with "id GAME players seat threshold hand", which the player answers
+// with "id @", then sends the usual messages. The player sends "id END" once
+// it has dropped a game (after GAMEOVER or an invalid message), after which
+// the id may be reused.
+#define MUX_ARG "mux"
+#define MUX_OPEN "GAME"
+#define MUX_CLOSE "END"
+#define MUX_MAX_GAMES 4096 // ids are below this
+
+// Categories of messages between hub and players
+enum MessageType {
+    HAND,
+    NEW_ROUND,
+    PLAYED,
+    GAME_OVER,
+    PLAY,
+    INVALID_MESSAGE
+};
+
+// A decoded message
+typedef struct {
+    enum MessageType type;
+    int number; // hand size, lead player or player who played, else 0
+    Card card; // card for PLAYED and PLAY, else NO_CARD
+} Message;
+
+/* Encode a HAND message
+ *
+ * @param buffer - buffer of at least HAND_MESSAGE_SIZE(numCards) chars
+ * @param cards - cards in the hand
+ * @param numCards - number of cards in the hand
+ * @return length of encoded message, including newline
+ */
+int encode_hand(char* buffer, const Card* cards, int numCards);
+
+/* Encode a NEWROUND message
+ *
+ * @param buffer - buffer of at least MESSAGE_SIZE chars
+ * @param leadPlayer - player leading the round
+ * @return length of encoded message, including newline
+ */
+int encode_new_round(char* buffer, int leadPlayer);
+
+/* Encode a PLAYED message
+ *
+ * @param buffer - buffer of at least MESSAGE_SIZE chars
+ * @param player - player who played the card
+ * @param card - card that was played
+ * @return length of encoded message, including newline
+ */
+int encode_played(char* buffer, int player, Card card);
+
+/* Encode a GAMEOVER message
+ *
+ * @param buffer - buffer of at least MESSAGE_SIZE chars
+ * @return length of encoded message, including newline
+ */
+int encode_game_over(char* buffer);
+
+/* Encode a PLAY message
+ *
+ * @param buffer - buffer of at least MESSAGE_SIZE chars
+ * @param card - card being played
+ * @return length of encoded message, including newline
+ */
+int encode_play(char* buffer, Card card);
+
+/* Classify and parse a message in a single pass
+ * Numbers must be unsigned decimal and cards a suit followed by one lower
+ * case hex digit, with nothing else on the line
+ *
+ * @param line - null terminated message, without newline
+ * @param message - pointer to store decoded message in
+ * @param hand - where to store the cards of a HAND message
+ * @param handCapacity - number of cards hand can hold
+ * @return type of message, INVALID_MESSAGE if it did not parse
+ */
+enum MessageType decode_message(const char* line, Message* message,
+        Card* hand, int handCapacity);
+
+#endif
@@ -0,0 +1,516 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "card.h"
+#include "protocol.h"
+#include "util.h"
+
+#define DEFAULT_GAMES 100
+#define DEFAULT_PLAYERS 4
+#define DEFAULT_THRESHOLD 2
+#define RECORDING_HEADER "2310replay" // starts each game of a recording
+#define ARG_SIZE 12 // fits any integer
+#define INVALID -1
+
+// Enum for all replay driver exit statuses
+enum ExitStatus {
+    NORMAL = 0,
+    USAGE = 1,
+    FILE_ERROR = 2,
+    PLAYER_ERROR = 3,
+    INVALID_PLAY = 4
+};
+
+// The player under test, the game as it sees it and what has been measured
+typedef struct {
+    pid_t pid;
+    FILE* toPlayer;
+    FILE* fromPlayer;
+    FILE* recording; // where every message sent is copied, or NULL
+    int numPlayers;
+    int seat; // player's ID
+    Card hand[FULL_DECK]; // NO_CARD once played
+    int handSize;
+    int leadPlayer; // INVALID outside a round
+    int playCount; // cards played so far this round
+    Suit leadSuit;
+    long messages; // messages sent over every game
+    uint64_t streamTime; // nanoseconds from HAND to GAMEOVER over every game
+    uint64_t* latencies; // nanoseconds from prompt to PLAY, per decision
+    long numDecisions;
+    long capacity;
+} Replay;
+
+/* Print an error message for an exit status and exit with that status
+ *
+ * @param status - the exit status
+ */
+void quit_replay(enum ExitStatus status) {
+    if (status == USAGE) {
+        fprintf(stderr, "Usage: 2310replay [-n games] [-s seed] "
+                "[-p players] [-t threshold] [-r recording] [-w recording] "
+                "player\n");
+    } else if (status == FILE_ERROR) {
+        fprintf(stderr, "Unable to use recording\n");
+    } else if (status == PLAYER_ERROR) {
+        fprintf(stderr, "Player error\n");
+    } else if (status == INVALID_PLAY) {
+        fprintf(stderr, "Invalid play\n");
+    }
+    exit(status);
+}
+
+/* Get the current time in nanoseconds
+ *
+ * @return CLOCK_MONOTONIC time
+ */
+static uint64_t now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+/* Fork and exec the player under test and wait for its '@'
+ *
+ * @param replay - replay state, whose game has been set up
+ * @param executable - player to run
+ * @param threshold - threshold of diamond cards
+ * @return true if the player could not be started
+ */
+static bool start_player(Replay* replay, char* executable, int threshold) {
+    char numPlayersArg[ARG_SIZE], playerIDArg[ARG_SIZE];
+    char thresholdArg[ARG_SIZE], handArg[ARG_SIZE];
+    sprintf(numPlayersArg, "%d", replay->numPlayers);
+    sprintf(playerIDArg, "%d", replay->seat);
+    sprintf(thresholdArg, "%d", threshold);
+    sprintf(handArg, "%d", replay->handSize);
+
+    int toPlayer[2], fromPlayer[2];
+    if (pipe(toPlayer)) {
+        return true;
+    }
+    if (pipe(fromPlayer)) {
+        close(toPlayer[0]);
+        close(toPlayer[1]);
+        return true;
+    }
+    replay->pid = fork();
+    if (replay->pid == -1) {
+        return true;
+    } else if (replay->pid == 0) { // player process
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(toPlayer[0], 0);
+        dup2(fromPlayer[1], 1);
+        dup2(devNull, 2);
+        close(toPlayer[1]);
+        close(fromPlayer[0]);
+        execlp(executable, executable, numPlayersArg, playerIDArg,
+                thresholdArg, handArg, (char*) 0);
+        _exit(0); // Shutdown if exec failed
+    }
+
+    close(toPlayer[0]);
+    close(fromPlayer[1]);
+    replay->toPlayer = fdopen(toPlayer[1], "w");
+    replay->fromPlayer = fdopen(fromPlayer[0], "r");
+    replay->leadPlayer = INVALID;
+    for (int i = 0; i < FULL_DECK; i++) {
+        replay->hand[i] = NO_CARD;
+    }
+    return fgetc(replay->fromPlayer) != '@';
+}
+
+/* Close the player's pipes and wait for it to exit
+ *
+ * @param replay - replay state
+ */
+static void finish_player(Replay* replay) {
+    fclose(replay->toPlayer);
+    fclose(replay->fromPlayer);
+    waitpid(replay->pid, NULL, 0);
+}
+
+/* Keep how long one decision took
+ *
+ * @param replay - replay state
+ * @param latency - nanoseconds from prompt to PLAY
+ */
+static void add_latency(Replay* replay, uint64_t latency) {
+    if (replay->numDecisions == replay->capacity) {
+        replay->capacity = replay->capacity ? replay->capacity * 2 : 1024;
+        replay->latencies = realloc(replay->latencies,
+                sizeof(uint64_t) * replay->capacity);
+    }
+    replay->latencies[replay->numDecisions++] = latency;
+}
+
+/* Flush everything sent so far, wait for the player's PLAY and check it
+ * follows the rules: the card must be held, and must follow the suit led
+ * if the player holds any of it
+ *
+ * @param replay - replay state, with the player due to play
+ * @return card played, exiting if the reply was missing or invalid
+ */
+static Card await_play(Replay* replay) {
+    fflush(replay->toPlayer);
+    uint64_t start = now();
+    char line[MESSAGE_SIZE];
+    if (fgets(line, sizeof(line), replay->fromPlayer) == NULL) {
+        quit_replay(PLAYER_ERROR);
+    }
+    add_latency(replay, now() - start);
+
+    Message message;
+    char* newline = strchr(line, '\n');
+    if (newline == NULL) {
+        quit_replay(INVALID_PLAY);
+    }
+    *newline = '\0';
+    if (decode_message(line, &message, NULL, 0) != PLAY) {
+        quit_replay(INVALID_PLAY);
+    }
+    int held = INVALID;
+    bool holdsLead = false;
+    for (int i = 0; i < replay->handSize; i++) {
+        if (replay->hand[i] == message.card) {
+            held = i;
+        }
+        holdsLead |= replay->hand[i] != NO_CARD
+                && card_suit(replay->hand[i]) == replay->leadSuit;
+    }
+    if (held == INVALID || (replay->playCount > 0 && holdsLead
+            && card_suit(message.card) != replay->leadSuit)) {
+        quit_replay(INVALID_PLAY);
+    }
+    replay->hand[held] = NO_CARD;
+    return message.card;
+}
+
+/* Count a card as played in the current round
+ *
+ * @param replay - replay state
+ * @param card - card played
+ */
+static void count_play(Replay* replay, Card card) {
+    if (replay->playCount++ == 0) {
+        replay->leadSuit = card_suit(card);
+    }
+}
+
+/* Send one message to the player, following the game it describes, and
+ * collect the player's PLAY if the message makes it the player's turn
+ * Messages are only flushed when a reply is due, so the player is sent as
+ * much as it will accept at once
+ *
+ * @param replay - replay state
+ * @param line - message, without newline
+ * @return card the player played in reply, or NO_CARD if none was due
+ */
+static Card deliver(Replay* replay, const char* line) {
+    fprintf(replay->toPlayer, "%s\n", line);
+    if (replay->recording != NULL) {
+        fprintf(replay->recording, "%s\n", line);
+    }
+    replay->messages++;
+
+    Message message;
+    switch (decode_message(line, &message, replay->hand, FULL_DECK)) {
+        case HAND:
+            replay->handSize = message.number;
+            return NO_CARD;
+        case NEW_ROUND:
+            replay->leadPlayer = message.number;
+            replay->playCount = 0;
+            break;
+        case PLAYED:
+            count_play(replay, message.card);
+            break;
+        case GAME_OVER:
+            fflush(replay->toPlayer);
+            return NO_CARD;
+        default:
+            quit_replay(FILE_ERROR);
+    }
+    if (replay->leadPlayer == INVALID || replay->playCount
+            == replay->numPlayers || (replay->leadPlayer
+            + replay->playCount) % replay->numPlayers != replay->seat) {
+        return NO_CARD;
+    }
+    Card card = await_play(replay);
+    count_play(replay, card);
+    return card;
+}
+
+/* Choose a card for a simulated seat: its first card of the suit led if it
+ * has one, otherwise its first card
+ *
+ * @param hand - seat's cards, NO_CARD once played
+ * @param handSize - length of hand
+ * @param leadCard - card led this round, or NO_CARD to lead
+ * @return index into hand of the card to play
+ */
+static int simulated_choice(const Card* hand, int handSize, Card leadCard) {
+    int first = INVALID;
+    for (int i = 0; i < handSize; i++) {
+        if (hand[i] == NO_CARD) {
+            continue;
+        }
+        if (leadCard != NO_CARD && card_suit(hand[i]) == card_suit(leadCard)) {
+            return i;
+        }
+        if (first == INVALID) {
+            first = i;
+        }
+    }
+    return first;
+}
+
+/* Play one game from a seeded deck against simulated seats, dealt and led
+ * as the hub would
+ *
+ * @param replay - replay state, whose player has been started
+ * @param seed - seed for the deck
+ */
+static void generate_game(Replay* replay, unsigned long seed) {
+    int numPlayers = replay->numPlayers;
+    int handSize = FULL_DECK / numPlayers;
+    Card deck[FULL_DECK];
+    shuffle_deck(seed, deck);
+    char buffer[HAND_MESSAGE_SIZE(FULL_DECK)];
+    int length = encode_hand(buffer, deck + replay->seat * handSize,
+            handSize);
+    buffer[length - 1] = '\0';
+    deliver(replay, buffer);
+
+    int lead = 0;
+    for (int round = 0; round < handSize; round++) {
+        Card played[FULL_DECK];
+        length = encode_new_round(buffer, lead);
+        buffer[length - 1] = '\0';
+        Card mine = deliver(replay, buffer);
+        for (int k = 0; k < numPlayers; k++) {
+            int player = (lead + k) % numPlayers;
+            if (player == replay->seat) {
+                played[k] = mine;
+                continue;
+            }
+            Card* hand = deck + player * handSize;
+            int index = simulated_choice(hand, handSize,
+                    k == 0 ? NO_CARD : played[0]);
+            played[k] = hand[index];
+            hand[index] = NO_CARD;
+            length = encode_played(buffer, player, played[k]);
+            buffer[length - 1] = '\0';
+            Card reply = deliver(replay, buffer);
+            if (reply != NO_CARD) {
+                mine = reply;
+            }
+        }
+        lead = (lead + round_winner(played, numPlayers)) % numPlayers;
+    }
+    length = encode_game_over(buffer);
+    buffer[length - 1] = '\0';
+    deliver(replay, buffer);
+}
+
+/* Play every game of a recording, each in a new player process
+ * Each game starts with a line "2310replay players seat threshold hand"
+ * followed by the messages the hub sent that seat
+ *
+ * @param replay - replay state
+ * @param filename - recording to play
+ * @param executable - player to run
+ * @return number of games played
+ */
+static long replay_recording(Replay* replay, char* filename,
+        char* executable) {
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) {
+        quit_replay(FILE_ERROR);
+    }
+    long games = 0;
+    uint64_t start = 0;
+    while (true) {
+        char* line;
+        int length = read_line(file, &line);
+        if (length == 0 && feof(file)) {
+            free(line);
+            break;
+        }
+        int numPlayers, seat, threshold, handSize;
+        char end;
+        if (sscanf(line, RECORDING_HEADER " %d %d %d %d%c", &numPlayers,
+                &seat, &threshold, &handSize, &end) == 4) {
+            if (games > 0) {
+                replay->streamTime += now() - start;
+                finish_player(replay);
+            }
+            if (numPlayers < 2 || seat < 0 || seat >= numPlayers
+                    || handSize < 1 || handSize > FULL_DECK) {
+                quit_replay(FILE_ERROR);
+            }
+            replay->numPlayers = numPlayers;
+            replay->seat = seat;
+            replay->handSize = handSize;
+            if (start_player(replay, executable, threshold)) {
+                quit_replay(PLAYER_ERROR);
+            }
+            games++;
+            start = now();
+        } else if (games == 0) {
+            quit_replay(FILE_ERROR);
+        } else {
+            deliver(replay, line);
+        }
+        free(line);
+    }
+    if (games > 0) {
+        replay->streamTime += now() - start;
+        finish_player(replay);
+    }
+    fclose(file);
+    return games;
+}
+
+/* Order latencies for percentiles
+ *
+ * @param a - first latency
+ * @param b - second latency
+ * @return negative, zero or positive as for qsort
+ */
+static int compare_latency(const void* a, const void* b) {
+    uint64_t first = *(const uint64_t*) a;
+    uint64_t second = *(const uint64_t*) b;
+    return (first > second) - (first < second);
+}
+
+/* Print throughput and decision latency
+ *
+ * @param replay - replay state after every game
+ * @param games - number of games played
+ */
+static void report(Replay* replay, long games) {
+    double seconds = replay->streamTime / 1e9;
+    printf("Games=%ld Messages=%ld Decisions=%ld\n", games, replay->messages,
+            replay->numDecisions);
+    printf("Messages/sec=%.0f\n", seconds > 0 ?
+            replay->messages / seconds : 0.0);
+    if (replay->numDecisions == 0) {
+        return;
+    }
+    qsort(replay->latencies, replay->numDecisions, sizeof(uint64_t),
+            compare_latency);
+    uint64_t total = 0;
+    for (long i = 0; i < replay->numDecisions; i++) {
+        total += replay->latencies[i];
+    }
+    long last = replay->numDecisions - 1;
+    printf("Decision latency (us): mean=%.1f p50=%.1f p99=%.1f max=%.1f\n",
+            (double) total / replay->numDecisions / 1000,
+            replay->latencies[last / 2] / 1000.0,
+            replay->latencies[last * 99 / 100] / 1000.0,
+            replay->latencies[last] / 1000.0);
+}
+
+/* Parse a numeric option
+ *
+ * @param text - option argument
+ * @param min - smallest value allowed
+ * @param max - largest value allowed
+ * @return value, exiting with USAGE if it is invalid
+ */
+static long parse_option(const char* text, long min, long max) {
+    char* end;
+    long value = strtol(text, &end, 10);
+    if (*end || *text == '\0' || value < min || value > max) {
+        quit_replay(USAGE);
+    }
+    return value;
+}
+
+int main(int argc, char** argv) {
+    long games = DEFAULT_GAMES;
+    unsigned long seed = 1;
+    int numPlayers = DEFAULT_PLAYERS;
+    int threshold = DEFAULT_THRESHOLD;
+    char* readName = NULL;
+    char* writeName = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:p:t:r:w:")) != -1) {
+        switch (opt) {
+            case 'n':
+                games = parse_option(optarg, 1, 100000000);
+                break;
+            case 's':
+                seed = parse_option(optarg, 0, INT32_MAX);
+                break;
+            case 'p':
+                numPlayers = parse_option(optarg, 2, FULL_DECK);
+                break;
+            case 't':
+                threshold = parse_option(optarg, 2, NUM_RANKS);
+                break;
+            case 'r':
+                readName = optarg;
+                break;
+            case 'w':
+                writeName = optarg;
+                break;
+            default:
+                quit_replay(USAGE);
+        }
+    }
+    if (optind != argc - 1 || (readName != NULL && writeName != NULL)) {
+        quit_replay(USAGE);
+    }
+    char* executable = argv[optind];
+    signal(SIGPIPE, SIG_IGN); // a player that dies shows up as EOF
+
+    Replay replay;
+    memset(&replay, 0, sizeof(replay));
+    if (readName != NULL) {
+        games = replay_recording(&replay, readName, executable);
+        report(&replay, games);
+        free(replay.latencies);
+        quit_replay(NORMAL);
+    }
+
+    if (writeName != NULL) {
+        replay.recording = fopen(writeName, "w");
+        if (replay.recording == NULL) {
+            quit_replay(FILE_ERROR);
+        }
+    }
+    replay.numPlayers = numPlayers;
+    replay.handSize = FULL_DECK / numPlayers;
+    for (long game = 0; game < games; game++) {
+        // every seat gets its turn at leading the first round
+        replay.seat = game % numPlayers;
+        if (replay.recording != NULL) {
+            fprintf(replay.recording, RECORDING_HEADER " %d %d %d %d\n",
+                    numPlayers, replay.seat, threshold, replay.handSize);
+        }
+        if (start_player(&replay, executable, threshold)) {
+            quit_replay(PLAYER_ERROR);
+        }
+        uint64_t start = now();
+        generate_game(&replay, seed + game);
+        replay.streamTime += now() - start;
+        finish_player(&replay);
+    }
+    if (replay.recording != NULL) {
+        fclose(replay.recording);
+    }
+    report(&replay, games);
+    free(replay.latencies);
+    quit_replay(NORMAL);
+}
@@ -0,0 +1,65 @@
+#ifndef RULES_H
+#define RULES_H
+
+// Every rules variant is defined here, and one is chosen at compile time by
+// defining RULES_<name> (make RULES=<name>), so the deck's size and suits
+// are constants wherever they are used. Each variant defines:
+//   SUITS(X) - X(suit, character) for each suit, in the order they are
+//              packed into a card
+//   NUM_RANKS - ranks in each suit, written as one hex digit so at most 16
+//   PENALTY_SUIT - suit whose cards won count against a player's score
+//   *_SUITS - suit orders the players' strategies prefer, naming every suit
+
+#if defined(RULES_STANDARD) || (!defined(RULES_SHORT) \
+        && !defined(RULES_HEARTS) && !defined(RULES_FIVE))
+// 4 suits of 16 ranks with D penalised, the game as it has always been
+#define SUITS(X) X(DIAMONDS, 'D') X(CLUBS, 'C') X(HEARTS, 'H') X(SPADES, 'S')
+#define NUM_RANKS 16
+#define PENALTY_SUIT DIAMONDS
+#define ALICE_LEAD_SUITS {SPADES, CLUBS, DIAMONDS, HEARTS}
+#define ALICE_DISCARD_SUITS {DIAMONDS, HEARTS, SPADES, CLUBS}
+#define BOB_LEAD_SUITS {DIAMONDS, HEARTS, SPADES, CLUBS}
+#define BOB_REACHED_SUITS {SPADES, CLUBS, HEARTS, DIAMONDS}
+#define BOB_DISCARD_SUITS {SPADES, CLUBS, DIAMONDS, HEARTS}
+
+#elif defined(RULES_SHORT)
+// 4 suits of 13 ranks with D penalised, as with a standard pack
+#define SUITS(X) X(DIAMONDS, 'D') X(CLUBS, 'C') X(HEARTS, 'H') X(SPADES, 'S')
+#define NUM_RANKS 13
+#define PENALTY_SUIT DIAMONDS
+#define ALICE_LEAD_SUITS {SPADES, CLUBS, DIAMONDS, HEARTS}
+#define ALICE_DISCARD_SUITS {DIAMONDS, HEARTS, SPADES, CLUBS}
+#define BOB_LEAD_SUITS {DIAMONDS, HEARTS, SPADES, CLUBS}
+#define BOB_REACHED_SUITS {SPADES, CLUBS, HEARTS, DIAMONDS}
+#define BOB_DISCARD_SUITS {SPADES, CLUBS, DIAMONDS, HEARTS}
+
+#elif defined(RULES_HEARTS)
+// 4 suits of 13 ranks with H penalised; the strategies treat H as they
+// would D and D as they would H
+#define SUITS(X) X(DIAMONDS, 'D') X(CLUBS, 'C') X(HEARTS, 'H') X(SPADES, 'S')
+#define NUM_RANKS 13
+#define PENALTY_SUIT HEARTS
+#define ALICE_LEAD_SUITS {SPADES, CLUBS, HEARTS, DIAMONDS}
+#define ALICE_DISCARD_SUITS {HEARTS, DIAMONDS, SPADES, CLUBS}
+#define BOB_LEAD_SUITS {HEARTS, DIAMONDS, SPADES, CLUBS}
+#define BOB_REACHED_SUITS {SPADES, CLUBS, DIAMONDS, HEARTS}
+#define BOB_DISCARD_SUITS {SPADES, CLUBS, HEARTS, DIAMONDS}
+
+#elif defined(RULES_FIVE)
+// 5 suits of 12 ranks with D penalised; R (rooks) ranks with the safe suits
+#define SUITS(X) X(DIAMONDS, 'D') X(CLUBS, 'C') X(HEARTS, 'H') \
+        X(SPADES, 'S') X(ROOKS, 'R')
+#define NUM_RANKS 12
+#define PENALTY_SUIT DIAMONDS
+#define ALICE_LEAD_SUITS {ROOKS, SPADES, CLUBS, DIAMONDS, HEARTS}
+#define ALICE_DISCARD_SUITS {DIAMONDS, HEARTS, SPADES, CLUBS, ROOKS}
+#define BOB_LEAD_SUITS {DIAMONDS, HEARTS, SPADES, CLUBS, ROOKS}
+#define BOB_REACHED_SUITS {ROOKS, SPADES, CLUBS, HEARTS, DIAMONDS}
+#define BOB_DISCARD_SUITS {ROOKS, SPADES, CLUBS, DIAMONDS, HEARTS}
+#endif
+
+#if NUM_RANKS > 16
+#error "ranks are written as a single hex digit"
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "spectate.h"
+
+/* Create (or replace) the shared memory ring spectators attach to
+ *
+ * @param name - shared memory object name, eg "/2310hub"
+ * @return mapped ring or NULL on failure
+ */
+SpectateRing* spectate_open(const char* name) {
+    shm_unlink(name); // spectators of an old ring must not see this one
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd == -1) {
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(SpectateRing))) {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    SpectateRing* ring = mmap(NULL, sizeof(SpectateRing),
+            PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        shm_unlink(name);
+        return NULL;
+    }
+    // the new object is zero filled, so only the magic needs writing
+    memcpy(ring->magic, SPECTATE_MAGIC, sizeof(ring->magic));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return ring;
+}
+
+/* Mark the ring closed and remove its name so no new spectators attach
+ * Spectators already attached can still drain it
+ *
+ * @param ring - ring from spectate_open
+ * @param name - name it was opened with
+ */
+void spectate_close(SpectateRing* ring, const char* name) {
+    __atomic_store_n(&ring->closed, 1, __ATOMIC_RELEASE);
+    shm_unlink(name);
+    munmap(ring, sizeof(SpectateRing));
+}
+
+/* Publish an event, overwriting the oldest if the ring is full
+ * Never waits on spectators
+ *
+ * @param ring - ring from spectate_open
+ * @param record - event to publish
+ */
+void spectate_publish(SpectateRing* ring, const SpectateRecord* record) {
+    // only the hub writes, so head needs no read-modify-write
+    uint64_t index = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    SpectateSlot* slot = &ring->slots[index & (SPECTATE_CAPACITY - 1)];
+    __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->record = *record;
+    __atomic_store_n(&slot->sequence, index + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->head, index + 1, __ATOMIC_RELEASE);
+}
+
+/* Copy out the event with the given index if it is still in the ring
+ *
+ * @param ring - attached ring
+ * @param index - index of event wanted, less than head
+ * @param record - where to store the event
+ * @return true if the event has already been overwritten
+ */
+bool spectate_read(const SpectateRing* ring, uint64_t index,
+        SpectateRecord* record) {
+    const SpectateSlot* slot = &ring->slots[index & (SPECTATE_CAPACITY - 1)];
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != index + 1) {
+        return true;
+    }
+    memcpy(record, &slot->record, sizeof(SpectateRecord));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    // the publisher may have started overwriting the slot while we copied
+    return __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) != index + 1;
+}
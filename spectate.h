@@ -0,0 +1,83 @@
+#ifndef SPECTATE_H
+#define SPECTATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "card.h"
+
+#define SPECTATE_ENV "SPECTATE_2310" // shared memory name to publish to
+#define SPECTATE_CAPACITY 4096 // events kept, must be power of 2
+#define SPECTATE_MAGIC "2310SPC1"
+
+// Kinds of event published to spectators
+enum SpectateEvent {
+    SPECTATE_START, // game dealt: player is number of players, number is
+                    // threshold
+    SPECTATE_PLAY, // player played card
+    SPECTATE_ROUND, // round won by player with card, number is lead player
+    SPECTATE_SCORE, // player finished with score number
+    SPECTATE_END // game stopped, number is the hub's exit status
+};
+
+// A single fixed size event
+typedef struct {
+    uint32_t game; // game the event belongs to
+    uint8_t event;
+    uint8_t card; // card played or winning card, else NO_CARD
+    int16_t player;
+    int32_t round; // rounds completed before this event
+    int32_t number;
+} SpectateRecord;
+
+// One slot of the ring
+// sequence is index + 1 of the event held once it is completely written,
+// and 0 while it is being overwritten
+typedef struct {
+    uint64_t sequence;
+    SpectateRecord record;
+} SpectateSlot;
+
+// Layout of the shared memory segment
+typedef struct {
+    char magic[8];
+    uint64_t head; // number of events ever published
+    uint32_t closed; // nonzero once the publisher has exited
+    uint32_t padding;
+    SpectateSlot slots[SPECTATE_CAPACITY];
+} SpectateRing;
+
+/* Create (or replace) the shared memory ring spectators attach to
+ *
+ * @param name - shared memory object name, eg "/2310hub"
+ * @return mapped ring or NULL on failure
+ */
+SpectateRing* spectate_open(const char* name);
+
+/* Mark the ring closed and remove its name so no new spectators attach
+ * Spectators already attached can still drain it
+ *
+ * @param ring - ring from spectate_open
+ * @param name - name it was opened with
+ */
+void spectate_close(SpectateRing* ring, const char* name);
+
+/* Publish an event, overwriting the oldest if the ring is full
+ * Never waits on spectators
+ *
+ * @param ring - ring from spectate_open
+ * @param record - event to publish
+ */
+void spectate_publish(SpectateRing* ring, const SpectateRecord* record);
+
+/* Copy out the event with the given index if it is still in the ring
+ *
+ * @param ring - attached ring
+ * @param index - index of event wanted, less than head
+ * @param record - where to store the event
+ * @return true if the event has already been overwritten
+ */
+bool spectate_read(const SpectateRing* ring, uint64_t index,
+        SpectateRecord* record);
+
+#endif
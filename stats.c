@@ -0,0 +1,644 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "card.h"
+
+#define INVALID -1
+#define LEAD_PREFIX "Lead player="
+#define CARDS_PREFIX "Cards="
+#define USAGE_PREFIX "Usage=" // a player's resource usage, not checked
+#define MAX_STORED_FLAGS 100 // per chunk, the rest are only counted
+#define MAX_FLAG_SIZE 80
+#define MAX_THREADS 256
+#define MAX_NUMBER 99999999 // larger numbers are rejected, avoiding overflow
+#define MIN_CHUNK (1 << 16) // smallest piece of log worth a thread
+
+// Enum for all analyzer exit statuses
+enum ExitStatus {
+    NORMAL = 0,
+    USAGE = 1,
+    FILE_ERROR = 2,
+    INCONSISTENT = 3
+};
+
+// A log line that disagrees with the rules
+typedef struct {
+    long line; // line number within the chunk, from 1
+    char reason[MAX_FLAG_SIZE];
+} Flag;
+
+// Totals gathered from any number of games
+typedef struct {
+    long games;
+    long incomplete;
+    long rounds;
+    long dPlayed;
+    int numSeats; // length of each per seat array
+    long* seatGames;
+    long* wins;
+    long* leads;
+    long* dWon;
+    long* scoreSum;
+    long* minScore;
+    long* maxScore;
+    int lowestScore; // score counted by scoreCounts[0]
+    int numScores; // length of scoreCounts
+    long* scoreCounts;
+    long totalFlags;
+    int numFlags;
+    Flag flags[MAX_STORED_FLAGS];
+} Stats;
+
+// State of the game currently being parsed
+typedef struct {
+    int numSeats; // 0 until the first Cards line
+    int lead; // lead player of the round in progress, -1 between rounds
+    int lastWinner; // winner of previous round, -1 at start of game
+    int rounds;
+    int capacity; // length of round, points and dWon
+    Card* round;
+    long* points;
+    long* dWon;
+} GameState;
+
+// A piece of a log processed by one thread, ending on a game boundary
+typedef struct {
+    const char* start;
+    const char* end;
+    long lines;
+    Stats stats;
+} Chunk;
+
+/* Exit after printing the correct error message
+ *
+ * @param status - the exit status to use
+ */
+void quit_stats(enum ExitStatus status) {
+    if (status == USAGE) {
+        fprintf(stderr, "Usage: 2310stats [-j threads] log {log}\n");
+    } else if (status == FILE_ERROR) {
+        fprintf(stderr, "Unable to read log\n");
+    }
+    exit(status);
+}
+
+/* Grow a per seat array, zeroing the new entries
+ *
+ * @param array - array to grow
+ * @param oldSize - current length
+ * @param newSize - length wanted
+ * @return grown array
+ */
+long* grow_array(long* array, int oldSize, int newSize) {
+    array = realloc(array, sizeof(long) * newSize);
+    memset(array + oldSize, 0, sizeof(long) * (newSize - oldSize));
+    return array;
+}
+
+/* Make sure stats has room for a number of seats
+ *
+ * @param stats - stats to grow
+ * @param numSeats - number of seats needed
+ */
+void ensure_seats(Stats* stats, int numSeats) {
+    if (numSeats <= stats->numSeats) {
+        return;
+    }
+    int old = stats->numSeats;
+    stats->seatGames = grow_array(stats->seatGames, old, numSeats);
+    stats->wins = grow_array(stats->wins, old, numSeats);
+    stats->leads = grow_array(stats->leads, old, numSeats);
+    stats->dWon = grow_array(stats->dWon, old, numSeats);
+    stats->scoreSum = grow_array(stats->scoreSum, old, numSeats);
+    stats->minScore = grow_array(stats->minScore, old, numSeats);
+    stats->maxScore = grow_array(stats->maxScore, old, numSeats);
+    stats->numSeats = numSeats;
+}
+
+/* Count occurrences of a score in the score distribution
+ *
+ * @param stats - stats to add to
+ * @param score - score seen
+ * @param count - number of times it was seen
+ */
+void count_score(Stats* stats, int score, long count) {
+    if (stats->numScores == 0) {
+        stats->lowestScore = score;
+    }
+    int low = score < stats->lowestScore ? score : stats->lowestScore;
+    int high = stats->lowestScore + stats->numScores - 1;
+    high = score > high || stats->numScores == 0 ? score : high;
+    if (low != stats->lowestScore || high - low + 1 != stats->numScores) {
+        long* counts = calloc(high - low + 1, sizeof(long));
+        for (int i = 0; i < stats->numScores; i++) {
+            counts[stats->lowestScore - low + i] = stats->scoreCounts[i];
+        }
+        free(stats->scoreCounts);
+        stats->scoreCounts = counts;
+        stats->lowestScore = low;
+        stats->numScores = high - low + 1;
+    }
+    stats->scoreCounts[score - low] += count;
+}
+
+/* Record a line that disagrees with the rules
+ *
+ * @param stats - stats to record flag in
+ * @param line - line number within the chunk
+ * @param reason - description of the problem
+ */
+void flag_line(Stats* stats, long line, const char* reason) {
+    stats->totalFlags++;
+    if (stats->numFlags < MAX_STORED_FLAGS) {
+        stats->flags[stats->numFlags].line = line;
+        strncpy(stats->flags[stats->numFlags].reason, reason,
+                MAX_FLAG_SIZE - 1);
+        stats->flags[stats->numFlags].reason[MAX_FLAG_SIZE - 1] = '\0';
+        stats->numFlags++;
+    }
+}
+
+/* Forget the game in progress, ready for the next one
+ *
+ * @param game - game state to reset
+ */
+void reset_game(GameState* game) {
+    game->numSeats = 0;
+    game->lead = INVALID;
+    game->lastWinner = INVALID;
+    game->rounds = 0;
+    if (game->capacity > 0) {
+        memset(game->points, 0, sizeof(long) * game->capacity);
+        memset(game->dWon, 0, sizeof(long) * game->capacity);
+    }
+}
+
+/* Make sure the game state can hold a number of seats
+ *
+ * @param game - game state to grow
+ * @param numSeats - number of seats needed
+ */
+void ensure_capacity(GameState* game, int numSeats) {
+    if (numSeats <= game->capacity) {
+        return;
+    }
+    game->round = realloc(game->round, sizeof(Card) * numSeats);
+    game->points = grow_array(game->points, game->capacity, numSeats);
+    game->dWon = grow_array(game->dWon, game->capacity, numSeats);
+    game->capacity = numSeats;
+}
+
+/* Parse a decimal number, which may be negative
+ *
+ * @param text - pointer to text to parse, updated to point after number
+ * @param end - end of the line
+ * @param number - pointer to store number in
+ * @return false if a number was parsed, true otherwise
+ */
+bool parse_number(const char** text, const char* end, int* number) {
+    const char* next = *text;
+    bool negative = next < end && *next == '-';
+    if (negative) {
+        next++;
+    }
+    if (next == end || *next < '0' || *next > '9') {
+        return true;
+    }
+    int value = 0;
+    while (next < end && *next >= '0' && *next <= '9') {
+        value = value * 10 + (*next++ - '0');
+        if (value > MAX_NUMBER) {
+            return true;
+        }
+    }
+    *number = negative ? -value : value;
+    *text = next;
+    return false;
+}
+
+/* Handle a "Lead player=N" line
+ *
+ * @param stats - stats to update
+ * @param game - game in progress
+ * @param text - text after the prefix
+ * @param end - end of the line
+ * @param line - line number within the chunk
+ */
+void handle_lead(Stats* stats, GameState* game, const char* text,
+        const char* end, long line) {
+    int lead;
+    if (parse_number(&text, end, &lead) || text != end || lead < 0) {
+        flag_line(stats, line, "malformed lead player line");
+        return;
+    }
+    if (game->lead != INVALID) {
+        // the previous game stopped part way through, this starts a new one
+        stats->incomplete++;
+        reset_game(game);
+    }
+    // a flagged lead is not kept, so the round's cards line is skipped
+    if (game->lastWinner == INVALID && lead != 0) {
+        flag_line(stats, line, "first round not led by player 0");
+    } else if (game->lastWinner != INVALID && lead != game->lastWinner) {
+        flag_line(stats, line, "lead player did not win previous round");
+    } else if (game->numSeats > 0 && lead >= game->numSeats) {
+        flag_line(stats, line, "lead player out of range");
+    } else {
+        game->lead = lead;
+    }
+}
+
+/* Handle a "Cards=S.x ..." line, working out who won the round
+ *
+ * @param stats - stats to update
+ * @param game - game in progress
+ * @param text - text after the prefix
+ * @param end - end of the line
+ * @param line - line number within the chunk
+ */
+void handle_cards(Stats* stats, GameState* game, const char* text,
+        const char* end, long line) {
+    if (game->lead == INVALID) {
+        flag_line(stats, line, "cards played without a lead player");
+        return;
+    }
+    int numCards = 0;
+    while (text < end) {
+        // each card is "S.x" followed by a space or the end of the line
+        char cardText[CARD_TEXT_SIZE] = {text[0], '\0', '\0'};
+        if (end - text < 3 || text[1] != '.' ||
+                (end - text > 3 && text[3] != ' ')) {
+            flag_line(stats, line, "malformed cards line");
+            game->lead = INVALID;
+            return;
+        }
+        cardText[1] = text[2];
+        ensure_capacity(game, numCards + 1);
+        if (parse_card(cardText, &game->round[numCards++])) {
+            flag_line(stats, line, "invalid card");
+            game->lead = INVALID;
+            return;
+        }
+        text += end - text > 3 ? 4 : 3;
+    }
+    if (numCards == 0 || (game->numSeats > 0 && numCards != game->numSeats)) {
+        flag_line(stats, line, "wrong number of cards played");
+        game->lead = INVALID;
+        return;
+    }
+    if (game->numSeats == 0) {
+        game->numSeats = numCards;
+    }
+    if (game->lead >= numCards) {
+        flag_line(stats, line, "lead player out of range");
+        game->lead = INVALID;
+        return;
+    }
+
+    int winner = (round_winner(game->round, numCards) + game->lead)
+            % numCards;
+    int dPlayed = 0;
+    for (int i = 0; i < numCards; i++) {
+        if (card_suit(game->round[i]) == PENALTY_SUIT) {
+            dPlayed++;
+        }
+    }
+    ensure_seats(stats, numCards);
+    stats->rounds++;
+    stats->leads[game->lead]++;
+    stats->dPlayed += dPlayed;
+    stats->dWon[winner] += dPlayed;
+    game->points[winner]++;
+    game->dWon[winner] += dPlayed;
+    game->lastWinner = winner;
+    game->lead = INVALID;
+    game->rounds++;
+}
+
+/* Handle a final "0:s 1:s ..." scores line, checking each score against
+ * the rounds that were played
+ *
+ * @param stats - stats to update
+ * @param game - game in progress
+ * @param text - start of the line
+ * @param end - end of the line
+ * @param line - line number within the chunk
+ */
+void handle_scores(Stats* stats, GameState* game, const char* text,
+        const char* end, long line) {
+    if (game->rounds == 0 || game->lead != INVALID) {
+        flag_line(stats, line, "scores without a complete game");
+        stats->incomplete++;
+        reset_game(game);
+        return;
+    }
+    int* scores = malloc(sizeof(int) * game->numSeats);
+    int numScores = 0;
+    while (text < end) {
+        int seat, score;
+        if (parse_number(&text, end, &seat) || text == end ||
+                *text++ != ':' || parse_number(&text, end, &score) ||
+                (text < end && *text++ != ' ') ||
+                seat != numScores || numScores == game->numSeats) {
+            flag_line(stats, line, "malformed scores line");
+            free(scores);
+            stats->incomplete++;
+            reset_game(game);
+            return;
+        }
+        scores[numScores++] = score;
+    }
+    if (numScores != game->numSeats) {
+        flag_line(stats, line, "wrong number of scores");
+        free(scores);
+        stats->incomplete++;
+        reset_game(game);
+        return;
+    }
+
+    // without the threshold, a score can be either side of the D penalty
+    int best = scores[0];
+    for (int i = 0; i < numScores; i++) {
+        if (scores[i] != game->points[i] - game->dWon[i] &&
+                scores[i] != game->points[i] + game->dWon[i]) {
+            flag_line(stats, line, "score does not match rounds won");
+        }
+        best = scores[i] > best ? scores[i] : best;
+    }
+    stats->games++;
+    ensure_seats(stats, numScores);
+    for (int i = 0; i < numScores; i++) {
+        if (stats->seatGames[i] == 0 || scores[i] < stats->minScore[i]) {
+            stats->minScore[i] = scores[i];
+        }
+        if (stats->seatGames[i] == 0 || scores[i] > stats->maxScore[i]) {
+            stats->maxScore[i] = scores[i];
+        }
+        stats->seatGames[i]++;
+        stats->scoreSum[i] += scores[i];
+        if (scores[i] == best) {
+            stats->wins[i]++;
+        }
+        count_score(stats, scores[i], 1);
+    }
+    free(scores);
+    reset_game(game);
+}
+
+/* Parse every line of a chunk
+ *
+ * @param arg - chunk to process
+ * @return NULL
+ */
+void* process_chunk(void* arg) {
+    Chunk* chunk = arg;
+    Stats* stats = &chunk->stats;
+    GameState game;
+    memset(&game, 0, sizeof(game));
+    reset_game(&game);
+
+    long line = 0;
+    const char* text = chunk->start;
+    while (text < chunk->end) {
+        const char* end = memchr(text, '\n', chunk->end - text);
+        if (end == NULL) {
+            end = chunk->end;
+        }
+        line++;
+        if (end - text >= strlen(LEAD_PREFIX) &&
+                memcmp(text, LEAD_PREFIX, strlen(LEAD_PREFIX)) == 0) {
+            handle_lead(stats, &game, text + strlen(LEAD_PREFIX), end, line);
+        } else if (end - text >= strlen(CARDS_PREFIX) &&
+                memcmp(text, CARDS_PREFIX, strlen(CARDS_PREFIX)) == 0) {
+            handle_cards(stats, &game, text + strlen(CARDS_PREFIX), end,
+                    line);
+        } else if (text < end && *text >= '0' && *text <= '9') {
+            handle_scores(stats, &game, text, end, line);
+        } else if (end - text >= strlen(USAGE_PREFIX) &&
+                memcmp(text, USAGE_PREFIX, strlen(USAGE_PREFIX)) == 0) {
+            // players' usage follows the scores and is not part of the game
+        } else {
+            flag_line(stats, line, "unrecognised line");
+        }
+        text = end + 1;
+    }
+    if (game.rounds > 0 || game.lead != INVALID) {
+        stats->incomplete++;
+    }
+    chunk->lines = line;
+    free(game.round);
+    free(game.points);
+    free(game.dWon);
+    return NULL;
+}
+
+/* Find the first game boundary (the end of a scores line) at or after a
+ * position in the log
+ *
+ * @param from - position to search from, which may be mid line
+ * @param end - end of the log
+ * @return position just after a scores line, or end if there is none
+ */
+const char* next_boundary(const char* from, const char* end) {
+    const char* text = memchr(from, '\n', end - from);
+    while (text != NULL && ++text < end) {
+        const char* lineEnd = memchr(text, '\n', end - text);
+        if (*text >= '0' && *text <= '9') {
+            return lineEnd == NULL ? end : lineEnd + 1;
+        }
+        text = lineEnd;
+    }
+    return end;
+}
+
+/* Add one set of stats into another
+ *
+ * @param total - stats to add to
+ * @param stats - stats to add
+ */
+void merge_stats(Stats* total, Stats* stats) {
+    total->games += stats->games;
+    total->incomplete += stats->incomplete;
+    total->rounds += stats->rounds;
+    total->dPlayed += stats->dPlayed;
+    total->totalFlags += stats->totalFlags;
+    ensure_seats(total, stats->numSeats);
+    for (int i = 0; i < stats->numSeats; i++) {
+        if (stats->seatGames[i] > 0) {
+            if (total->seatGames[i] == 0 ||
+                    stats->minScore[i] < total->minScore[i]) {
+                total->minScore[i] = stats->minScore[i];
+            }
+            if (total->seatGames[i] == 0 ||
+                    stats->maxScore[i] > total->maxScore[i]) {
+                total->maxScore[i] = stats->maxScore[i];
+            }
+        }
+        total->seatGames[i] += stats->seatGames[i];
+        total->wins[i] += stats->wins[i];
+        total->leads[i] += stats->leads[i];
+        total->dWon[i] += stats->dWon[i];
+        total->scoreSum[i] += stats->scoreSum[i];
+    }
+    for (int i = 0; i < stats->numScores; i++) {
+        if (stats->scoreCounts[i] > 0) {
+            count_score(total, stats->lowestScore + i, stats->scoreCounts[i]);
+        }
+    }
+}
+
+/* Free the arrays held by a set of stats
+ *
+ * @param stats - stats to free
+ */
+void free_stats(Stats* stats) {
+    free(stats->seatGames);
+    free(stats->wins);
+    free(stats->leads);
+    free(stats->dWon);
+    free(stats->scoreSum);
+    free(stats->minScore);
+    free(stats->maxScore);
+    free(stats->scoreCounts);
+}
+
+/* Analyse one log file, splitting it between threads on game boundaries
+ * Lines that disagree with the rules are reported to stderr
+ *
+ * @param filename - log to analyse
+ * @param numThreads - most threads to use
+ * @param total - stats to add this log's results to
+ * @return false on success, true if the file could not be read
+ */
+bool analyse_file(char* filename, int numThreads, Stats* total) {
+    int fd = open(filename, O_RDONLY);
+    struct stat info;
+    if (fd == -1 || fstat(fd, &info)) {
+        return true;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    const char* log = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (log == MAP_FAILED) {
+        return true;
+    }
+    madvise((void*) log, info.st_size, MADV_SEQUENTIAL);
+    const char* end = log + info.st_size;
+
+    if (info.st_size / MIN_CHUNK + 1 < numThreads) {
+        numThreads = info.st_size / MIN_CHUNK + 1;
+    }
+    Chunk* chunks = calloc(numThreads, sizeof(Chunk));
+    pthread_t* threads = malloc(sizeof(pthread_t) * numThreads);
+    const char* start = log;
+    int numChunks = 0;
+    for (int i = 0; i < numThreads && start < end; i++) {
+        const char* chunkEnd = i == numThreads - 1 ? end
+                : next_boundary(log + info.st_size / numThreads * (i + 1),
+                end);
+        if (chunkEnd <= start) {
+            continue;
+        }
+        chunks[numChunks].start = start;
+        chunks[numChunks].end = chunkEnd;
+        pthread_create(&threads[numChunks], NULL, process_chunk,
+                &chunks[numChunks]);
+        numChunks++;
+        start = chunkEnd;
+    }
+
+    long lineBase = 0;
+    for (int i = 0; i < numChunks; i++) {
+        pthread_join(threads[i], NULL);
+        Stats* stats = &chunks[i].stats;
+        for (int j = 0; j < stats->numFlags; j++) {
+            fprintf(stderr, "%s:%ld: %s\n", filename,
+                    lineBase + stats->flags[j].line, stats->flags[j].reason);
+        }
+        if (stats->totalFlags > stats->numFlags) {
+            fprintf(stderr, "%s: %ld more inconsistent lines after line %ld\n",
+                    filename, stats->totalFlags - stats->numFlags,
+                    lineBase + stats->flags[stats->numFlags - 1].line);
+        }
+        lineBase += chunks[i].lines;
+        merge_stats(total, stats);
+        free_stats(stats);
+    }
+    free(chunks);
+    free(threads);
+    munmap((void*) log, info.st_size);
+    return false;
+}
+
+/* Print the combined results
+ *
+ * @param stats - stats for every log
+ */
+void print_report(Stats* stats) {
+    printf("Games=%ld Incomplete=%ld Rounds=%ld\n", stats->games,
+            stats->incomplete, stats->rounds);
+    printf("Seat Games WinRate LeadRate DCapture MeanScore MinScore "
+            "MaxScore\n");
+    for (int i = 0; i < stats->numSeats; i++) {
+        long games = stats->seatGames[i];
+        printf("%d %ld %.4f %.4f %.4f %.3f %ld %ld\n", i, games,
+                games ? (double) stats->wins[i] / games : 0.0,
+                stats->rounds ? (double) stats->leads[i] / stats->rounds : 0.0,
+                stats->dPlayed ? (double) stats->dWon[i] / stats->dPlayed
+                : 0.0, games ? (double) stats->scoreSum[i] / games : 0.0,
+                games ? stats->minScore[i] : 0,
+                games ? stats->maxScore[i] : 0);
+    }
+    printf("Scores=");
+    bool first = true;
+    for (int i = 0; i < stats->numScores; i++) {
+        if (stats->scoreCounts[i] > 0) {
+            printf("%s%d:%ld", first ? "" : " ", stats->lowestScore + i,
+                    stats->scoreCounts[i]);
+            first = false;
+        }
+    }
+    printf("\nInconsistent=%ld\n", stats->totalFlags);
+}
+
+int main(int argc, char** argv) {
+    int numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+    while ((opt = getopt(argc, argv, "j:")) != -1) {
+        char* end;
+        if (opt != 'j') {
+            quit_stats(USAGE);
+        }
+        numThreads = strtol(optarg, &end, 10);
+        if (numThreads < 1 || *end) {
+            quit_stats(USAGE);
+        }
+    }
+    if (optind == argc) {
+        quit_stats(USAGE);
+    }
+    if (numThreads < 1 || numThreads > MAX_THREADS) {
+        numThreads = numThreads < 1 ? 1 : MAX_THREADS;
+    }
+
+    Stats total;
+    memset(&total, 0, sizeof(total));
+    for (int i = optind; i < argc; i++) {
+        if (analyse_file(argv[i], numThreads, &total)) {
+            quit_stats(FILE_ERROR);
+        }
+    }
+    print_report(&total);
+    free_stats(&total);
+    quit_stats(total.totalFlags > 0 ? INCONSISTENT : NORMAL);
+}
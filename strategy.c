@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "strategy.h"
+
+const BobParams defaultBobParams = {
+    BOB_LEAD_SUITS,
+    BOB_REACHED_SUITS,
+    BOB_DISCARD_SUITS,
+    2
+};
+
+/* Parse one suit order, eg "DHSC"
+ *
+ * @param text - where the order starts, advanced past it
+ * @param order - where to store the order
+ * @return true if it does not name every suit exactly once
+ */
+static bool parse_order(const char** text, Suit* order) {
+    bool seen[NUM_SUITS] = {false};
+    for (int i = 0; i < NUM_SUITS; i++) {
+        int suit = parse_suit((*text)[i]);
+        if (suit == INVALID || seen[suit]) {
+            return true;
+        }
+        seen[suit] = true;
+        order[i] = suit;
+    }
+    *text += NUM_SUITS;
+    return false;
+}
+
+/* Parse parameters written by format_bob_params, eg "DHSC,SCHD,SCDH,2"
+ * Each order must name every suit exactly once
+ *
+ * @param text - text to parse
+ * @param params - where to store the parameters
+ * @return true if text is not valid parameters
+ */
+bool parse_bob_params(const char* text, BobParams* params) {
+    Suit* orders[] = {params->leadOrder, params->reachedOrder,
+            params->discardOrder};
+    for (int i = 0; i < 3; i++) {
+        if (parse_order(&text, orders[i]) || *text++ != ',') {
+            return true;
+        }
+    }
+    int length;
+    if (sscanf(text, "%d%n", &params->thresholdMargin, &length) != 1 ||
+            text[length] || params->thresholdMargin < 0) {
+        return true;
+    }
+    return false;
+}
+
+/* Write parameters in the form parse_bob_params reads
+ *
+ * @param params - parameters to write
+ * @param buffer - buffer of at least BOB_PARAMS_SIZE chars
+ */
+void format_bob_params(const BobParams* params, char* buffer) {
+    const Suit* orders[] = {params->leadOrder, params->reachedOrder,
+            params->discardOrder};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < NUM_SUITS; j++) {
+            *buffer++ = suit_char(orders[i][j]);
+        }
+        *buffer++ = ',';
+    }
+    sprintf(buffer, "%d", params->thresholdMargin);
+}
+
+/* Choose a card the way alice does
+ *
+ * @param game - main game struct
+ * @return index of chosen card
+ */
+int alice_choose(Game* game) {
+
+    if (game->playerID == game->leadPlayer) {
+        Suit suitPreference[] = ALICE_LEAD_SUITS;
+        for (int i = 0; i < NUM_SUITS; i++) {
+            // find highest suit
+            int cardIndex = find_highest_suit(game, suitPreference[i]);
+            if (cardIndex != INVALID) {
+                return cardIndex;
+            }
+        }
+    }
+
+    // play lowest card in lead suit
+    int cardIndex = find_lowest_suit(game,
+            card_suit(game->turn[game->leadPlayer]));
+    if (cardIndex != -1) {
+        return cardIndex;
+    }
+
+    // remaining choices
+
+    Suit suitPreference[] = ALICE_DISCARD_SUITS;
+    for (int i = 0; i < NUM_SUITS; i++) {
+        // find highest suit
+        int cardIndex = find_highest_suit(game, suitPreference[i]);
+        if (cardIndex != INVALID) {
+            return cardIndex;
+        }
+    }
+    return INVALID; // Should never get here
+}
+
+/* Check if any player has reached threshold - margin D cards
+ *
+ * @param game - main game struct
+ * @param margin - how far below the threshold counts
+ * @return true iff at least one player has reached threshold - margin D cards
+ */
+static bool threshold_reached(Game* game, int margin) {
+    for (int i = 0; i < game->numPlayers; i++) {
+        if (game->dWon[i] >= game->threshold - margin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Check if any player has played a D card this round
+ *
+ * @param game - main game struct
+ * @return true iff at least one player has played a D card this round
+ */
+static bool played_d(Game* game) {
+    for (int i = 0; i < game->playerCount; i++) {
+        if (card_suit(game->turn[(i + game->leadPlayer)
+                % game->numPlayers]) == PENALTY_SUIT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Check whether bob thinks D cards are at stake this round: a player is
+ * close to the threshold and a D card has been played
+ *
+ * @param game - main game struct
+ * @param params - bob's parameters
+ * @return true iff bob would try to win the round
+ */
+bool bob_contesting(Game* game, const BobParams* params) {
+    return threshold_reached(game, params->thresholdMargin) && played_d(game);
+}
+
+/* Choose a card the way bob does
+ *
+ * @param game - main game struct
+ * @param params - choices to make
+ * @return index of chosen card
+ */
+int bob_choose(Game* game, const BobParams* params) {
+    if (game->playerID == game->leadPlayer) {
+        for (int i = 0; i < NUM_SUITS; i++) {
+            // find lowest card in suit
+            int cardIndex = find_lowest_suit(game, params->leadOrder[i]);
+            if (cardIndex != -1) {
+                return cardIndex;
+            }
+        }
+    }
+
+    if (bob_contesting(game, params)) {
+        // play highest card in lead suit
+        int cardIndex = find_highest_suit(game,
+                card_suit(game->turn[game->leadPlayer]));
+        if (cardIndex != INVALID) {
+            return cardIndex;
+        }
+        for (int i = 0; i < NUM_SUITS; i++) { 
+            // find lowest card in suit
+            int cardIndex = find_lowest_suit(game, params->reachedOrder[i]);
+            if (cardIndex != INVALID) {
+                return cardIndex;
+            }
+        }
+    } else {
+        // play lowest card in lead suit
+        int cardIndex = find_lowest_suit(game,
+                card_suit(game->turn[game->leadPlayer]));
+        if (cardIndex != INVALID) {
+            return cardIndex;
+        }
+        for (int i = 0; i < NUM_SUITS; i++) {
+            // find highest card in suit
+            int cardIndex = find_highest_suit(game, params->discardOrder[i]);
+            if (cardIndex != INVALID) {
+                return cardIndex;
+            }
+        }
+    }
+    return -1; // Should never reach here
+}
@@ -0,0 +1,67 @@
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include <stdbool.h>
+
+#include "card.h"
+#include "player.h"
+
+#define BOB_PARAMS_ENV "BOB_PARAMS_2310" // overrides bob's parameters
+// fits formatted parameters: three suit orders, commas, margin and terminator
+#define BOB_PARAMS_SIZE (3 * (NUM_SUITS + 1) + 12)
+
+// The choices bob's strategy makes, so they can be tuned
+typedef struct {
+    Suit leadOrder[NUM_SUITS]; // when leading, lowest card of first suit held
+    Suit reachedOrder[NUM_SUITS]; // when D is at stake and unable to follow,
+                                  // lowest card of first suit held
+    Suit discardOrder[NUM_SUITS]; // otherwise when unable to follow,
+                                  // highest card of first suit held
+    int thresholdMargin; // D is at stake once a player has won
+                         // threshold - thresholdMargin D cards
+} BobParams;
+
+// Parameters bob has always played with
+extern const BobParams defaultBobParams;
+
+/* Parse parameters written by format_bob_params, eg "DHSC,SCHD,SCDH,2"
+ * Each order must name every suit exactly once
+ *
+ * @param text - text to parse
+ * @param params - where to store the parameters
+ * @return true if text is not valid parameters
+ */
+bool parse_bob_params(const char* text, BobParams* params);
+
+/* Write parameters in the form parse_bob_params reads
+ *
+ * @param params - parameters to write
+ * @param buffer - buffer of at least BOB_PARAMS_SIZE chars
+ */
+void format_bob_params(const BobParams* params, char* buffer);
+
+/* Choose a card the way alice does
+ *
+ * @param game - main game struct
+ * @return index of chosen card
+ */
+int alice_choose(Game* game);
+
+/* Check whether bob thinks D cards are at stake this round: a player is
+ * close to the threshold and a D card has been played
+ *
+ * @param game - main game struct
+ * @param params - bob's parameters
+ * @return true iff bob would try to win the round
+ */
+bool bob_contesting(Game* game, const BobParams* params);
+
+/* Choose a card the way bob does
+ *
+ * @param game - main game struct
+ * @param params - choices to make
+ * @return index of chosen card
+ */
+int bob_choose(Game* game, const BobParams* params);
+
+#endif
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "metrics.h"
+
+#define DEFAULT_INTERVAL 1.0 // seconds between refreshes
+#define CLEAR_SCREEN "\033[H\033[J"
+
+// Enum for all viewer exit statuses
+enum ExitStatus {
+    NORMAL = 0,
+    USAGE = 1,
+    NO_SEGMENT = 2
+};
+
+/* Print an error message for an exit status and exit with that status
+ *
+ * @param status - the exit status
+ */
+void quit_top(enum ExitStatus status) {
+    if (status == USAGE) {
+        fprintf(stderr, "Usage: 2310top [-i seconds] [-n refreshes] name\n");
+    } else if (status == NO_SEGMENT) {
+        fprintf(stderr, "Unable to attach to metrics\n");
+    }
+    exit(status);
+}
+
+/* Get the current time in seconds
+ *
+ * @return CLOCK_MONOTONIC time
+ */
+static double clock_seconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/* Take a consistent enough copy of every counter
+ *
+ * @param metrics - live segment
+ * @param copy - where to store the counters
+ */
+static void snapshot(const Metrics* metrics, Metrics* copy) {
+    copy->gamesStarted = metrics_read(&metrics->gamesStarted);
+    copy->gamesCompleted = metrics_read(&metrics->gamesCompleted);
+    copy->rounds = metrics_read(&metrics->rounds);
+    copy->invalidExits = metrics_read(&metrics->invalidExits);
+    copy->eofExits = metrics_read(&metrics->eofExits);
+    copy->otherExits = metrics_read(&metrics->otherExits);
+    copy->currentRound = metrics_read(&metrics->currentRound);
+    for (int i = 0; i < METRICS_SEATS; i++) {
+        copy->messages[i] = metrics_read(&metrics->messages[i]);
+        copy->bytes[i] = metrics_read(&metrics->bytes[i]);
+    }
+}
+
+/* Print totals and the rates since the previous snapshot
+ *
+ * @param name - segment name
+ * @param now - latest counters
+ * @param before - counters seconds ago
+ * @param seconds - time between the snapshots
+ */
+static void display(const char* name, const Metrics* now,
+        const Metrics* before, double seconds) {
+    printf("%s\n", name);
+    printf("Games: started %llu completed %llu (%.1f/s) invalid %llu "
+            "eof %llu other %llu\n",
+            (unsigned long long) now->gamesStarted,
+            (unsigned long long) now->gamesCompleted,
+            (now->gamesCompleted - before->gamesCompleted) / seconds,
+            (unsigned long long) now->invalidExits,
+            (unsigned long long) now->eofExits,
+            (unsigned long long) now->otherExits);
+    printf("Rounds: %llu (%.1f/s) current round %llu\n",
+            (unsigned long long) now->rounds,
+            (now->rounds - before->rounds) / seconds,
+            (unsigned long long) now->currentRound);
+    printf("%-6s %12s %10s %14s %12s\n", "Seat", "Messages", "Msg/s",
+            "Bytes", "Bytes/s");
+    for (int i = 0; i < METRICS_SEATS; i++) {
+        if (now->messages[i] == 0) {
+            continue;
+        }
+        printf("%-6d %12llu %10.1f %14llu %12.1f\n", i,
+                (unsigned long long) now->messages[i],
+                (now->messages[i] - before->messages[i]) / seconds,
+                (unsigned long long) now->bytes[i],
+                (now->bytes[i] - before->bytes[i]) / seconds);
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    double interval = DEFAULT_INTERVAL;
+    long refreshes = -1; // forever
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:")) != -1) {
+        char* end;
+        if (opt == 'i') {
+            interval = strtod(optarg, &end);
+            if (*end || !(interval > 0)) {
+                quit_top(USAGE);
+            }
+        } else if (opt == 'n') {
+            refreshes = strtol(optarg, &end, 10);
+            if (*end || refreshes < 1) {
+                quit_top(USAGE);
+            }
+        } else {
+            quit_top(USAGE);
+        }
+    }
+    if (optind != argc - 1) {
+        quit_top(USAGE);
+    }
+    const Metrics* metrics = metrics_attach(argv[optind]);
+    if (metrics == NULL) {
+        quit_top(NO_SEGMENT);
+    }
+
+    bool terminal = isatty(STDOUT_FILENO);
+    Metrics before, now;
+    snapshot(metrics, &before);
+    double taken = clock_seconds(); // when before was snapshotted
+    struct timespec wait;
+    wait.tv_sec = (time_t) interval;
+    wait.tv_nsec = (long) ((interval - wait.tv_sec) * 1e9);
+    for (long i = 0; refreshes < 0 || i < refreshes; i++) {
+        nanosleep(&wait, NULL);
+        snapshot(metrics, &now);
+        // rates use the time actually elapsed, as sleeping overshoots and
+        // printing takes time too
+        double elapsed = clock_seconds() - taken;
+        taken += elapsed;
+        if (terminal) {
+            printf(CLEAR_SCREEN);
+        } else if (i > 0) {
+            printf("\n");
+        }
+        display(argv[optind], &now, &before, elapsed);
+        before = now;
+    }
+    quit_top(NORMAL);
+}
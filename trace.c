@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <limits.h>
+#include <time.h>
+
+#include "trace.h"
+
+bool traceEnabled = false;
+
+static TraceRecord* ring; // TRACE_CAPACITY events
+static uint64_t head; // total events ever recorded
+static TraceHeader header;
+static char tracePath[PATH_MAX];
+
+/* Write the ring buffer out, oldest event first
+ * Registered with atexit by trace_start
+ */
+static void trace_flush(void) {
+    if (!traceEnabled) {
+        return;
+    }
+    // a forked child that fails to exec must not overwrite our trace
+    if (getpid() != header.pid) {
+        return;
+    }
+    FILE* file = fopen(tracePath, "w");
+    if (file == NULL) {
+        return;
+    }
+    uint64_t end = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    uint64_t start = end > TRACE_CAPACITY ? end - TRACE_CAPACITY : 0;
+    fwrite(&header, sizeof(header), 1, file);
+    for (uint64_t i = start; i < end; i++) {
+        fwrite(&ring[i & (TRACE_CAPACITY - 1)], sizeof(TraceRecord), 1, file);
+    }
+    fclose(file);
+}
+
+/* Enable tracing if TRACE_ENV is set, allocating this process's ring
+ * buffer and arranging for it to be written out at exit
+ *
+ * @param seat - player ID of this process, or NO_SEAT for the hub
+ */
+void trace_start(int seat) {
+    char* directory = getenv(TRACE_ENV);
+    if (directory == NULL || *directory == '\0') {
+        return;
+    }
+    ring = malloc(sizeof(TraceRecord) * TRACE_CAPACITY);
+    if (ring == NULL) {
+        return;
+    }
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.pid = getpid();
+    header.seat = seat;
+    snprintf(tracePath, sizeof(tracePath), "%s/%s%d", directory,
+            TRACE_FILE_PREFIX, header.pid);
+    head = 0;
+    traceEnabled = true;
+    atexit(trace_flush);
+}
+
+/* Append an event to the ring buffer, overwriting the oldest if it is full
+ * Only call through trace_event
+ *
+ * @param record - event to append, time is filled in here
+ */
+void trace_record(TraceRecord* record) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    record->time = (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+    uint64_t slot = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+    ring[slot & (TRACE_CAPACITY - 1)] = *record;
+}
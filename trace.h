@@ -0,0 +1,118 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "card.h"
+
+#define TRACE_ENV "TRACE_2310" // directory to write traces to, if set
+#define TRACE_CAPACITY 65536 // events kept per process, must be power of 2
+#define TRACE_MAGIC "2310TRC1"
+#define TRACE_FILE_PREFIX "trace."
+#define NO_SEAT -1 // seat of the hub, or of an event about no one seat
+
+// Kinds of event that can be traced
+enum TraceEvent {
+    TRACE_SENT, // message written to a pipe
+    TRACE_RECEIVED, // message read from a pipe
+    TRACE_DECISION, // player chose a card
+    TRACE_ROUND, // round resolved
+    TRACE_CACHE // decision cache totals at GAMEOVER
+};
+
+// Start of every trace file, identifying the process it came from
+typedef struct {
+    char magic[8];
+    int32_t pid;
+    int32_t seat; // player ID, or NO_SEAT for the hub
+} TraceHeader;
+
+// A single fixed size event
+typedef struct {
+    uint64_t time; // CLOCK_MONOTONIC nanoseconds, comparable across processes
+    uint8_t event;
+    uint8_t type; // MessageType of a sent or received message
+    uint8_t card; // card in the message, chosen or winning, else NO_CARD
+    uint8_t padding;
+    int16_t seat; // player sent to, received from or who won, else NO_SEAT
+    int16_t lead; // lead player of a resolved round
+    int32_t number; // number in the message, index of card chosen or hits
+    int32_t extra; // decision cache misses
+} TraceRecord;
+
+// True once trace_start has found tracing enabled
+extern bool traceEnabled;
+
+/* Enable tracing if TRACE_ENV is set, allocating this process's ring
+ * buffer and arranging for it to be written out at exit
+ *
+ * @param seat - player ID of this process, or NO_SEAT for the hub
+ */
+void trace_start(int seat);
+
+/* Append an event to the ring buffer, overwriting the oldest if it is full
+ * Only call through trace_event
+ *
+ * @param record - event to append, time is filled in here
+ */
+void trace_record(TraceRecord* record);
+
+/* Trace an event if tracing is enabled; costs one branch otherwise
+ *
+ * @param event - kind of event
+ * @param type - MessageType of message, or 0
+ * @param seat - seat concerned, or NO_SEAT
+ * @param number - number in message or card index, or 0
+ * @param card - card concerned, or NO_CARD
+ */
+static inline void trace_event(enum TraceEvent event, int type, int seat,
+        int number, Card card) {
+    if (__builtin_expect(traceEnabled, 0)) {
+        TraceRecord record = {0};
+        record.event = event;
+        record.type = type;
+        record.seat = seat;
+        record.lead = NO_SEAT;
+        record.number = number;
+        record.card = card;
+        trace_record(&record);
+    }
+}
+
+/* Trace the end of a round if tracing is enabled
+ *
+ * @param lead - player who led the round
+ * @param winner - player who won the round
+ * @param card - winning card
+ */
+static inline void trace_round(int lead, int winner, Card card) {
+    if (__builtin_expect(traceEnabled, 0)) {
+        TraceRecord record = {0};
+        record.event = TRACE_ROUND;
+        record.seat = winner;
+        record.lead = lead;
+        record.card = card;
+        trace_record(&record);
+    }
+}
+
+/* Trace the decision cache's totals if tracing is enabled
+ *
+ * @param hits - decisions found in the cache
+ * @param misses - decisions that had to be made
+ */
+static inline void trace_cache(long hits, long misses) {
+    if (__builtin_expect(traceEnabled, 0)) {
+        TraceRecord record = {0};
+        record.event = TRACE_CACHE;
+        record.seat = NO_SEAT;
+        record.lead = NO_SEAT;
+        record.card = NO_CARD;
+        record.number = hits;
+        record.extra = misses;
+        trace_record(&record);
+    }
+}
+
+#endif
@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "card.h"
+#include "protocol.h"
+#include "trace.h"
+
+#define INVALID -1
+#define LABEL_SIZE 32
+
+// Enum for all trace merger exit statuses
+enum ExitStatus {
+    NORMAL = 0,
+    USAGE = 1,
+    FILE_ERROR = 2
+};
+
+// Events read from a single trace file
+typedef struct {
+    TraceHeader header;
+    TraceRecord* records;
+    long numRecords;
+    long next; // next record to merge
+} Trace;
+
+/* Print an error message for an exit status and exit with that status
+ *
+ * @param status - the exit status
+ */
+void quit_merge(enum ExitStatus status) {
+    if (status == USAGE) {
+        fprintf(stderr, "Usage: 2310trace trace {trace}\n");
+    } else if (status == FILE_ERROR) {
+        fprintf(stderr, "Unable to read trace\n");
+    }
+    exit(status);
+}
+
+/* Read every event in a trace file
+ *
+ * @param filename - trace file written by a hub or player
+ * @param trace - where to store the events
+ * @return true if the file could not be read or is not a trace
+ */
+bool read_trace(char* filename, Trace* trace) {
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) {
+        return true;
+    }
+    bool invalid = fread(&trace->header, sizeof(TraceHeader), 1, file) != 1
+            || memcmp(trace->header.magic, TRACE_MAGIC,
+            sizeof(trace->header.magic));
+    long capacity = 0;
+    trace->records = NULL;
+    trace->numRecords = 0;
+    trace->next = 0;
+    while (!invalid) {
+        if (trace->numRecords == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            trace->records = realloc(trace->records,
+                    sizeof(TraceRecord) * capacity);
+        }
+        long got = fread(trace->records + trace->numRecords,
+                sizeof(TraceRecord), capacity - trace->numRecords, file);
+        trace->numRecords += got;
+        if (trace->numRecords < capacity) {
+            break;
+        }
+    }
+    fclose(file);
+    return invalid;
+}
+
+/* Write the text form of a traced card, which a corrupt trace may not hold
+ *
+ * @param card - card byte from a record
+ * @param buffer - where to write the text, at least CARD_TEXT_SIZE bytes
+ * @return buffer, holding "?" if the byte is not a card
+ */
+char* render_card(uint8_t card, char* buffer) {
+    if (!card_valid(card)) {
+        strcpy(buffer, "?");
+        return buffer;
+    }
+    return card_to_text(card, buffer);
+}
+
+/* Render the message a sent or received event refers to, without newline
+ * A card that is not valid is shown as "?"
+ *
+ * @param record - sent or received event
+ * @param buffer - where to write the text, at least MESSAGE_SIZE bytes
+ */
+void render_message(const TraceRecord* record, char* buffer) {
+    int length = 0;
+    switch (record->type) {
+        case HAND:
+            // the cards themselves are not recorded
+            length = sprintf(buffer, "HAND%d (...)\n", record->number);
+            break;
+        case NEW_ROUND:
+            length = encode_new_round(buffer, record->number);
+            break;
+        case PLAYED:
+            if (!card_valid(record->card)) {
+                length = sprintf(buffer, "PLAYED%d,?\n", record->number);
+                break;
+            }
+            length = encode_played(buffer, record->number, record->card);
+            break;
+        case GAME_OVER:
+            length = encode_game_over(buffer);
+            break;
+        case PLAY:
+            if (!card_valid(record->card)) {
+                length = sprintf(buffer, "PLAY?\n");
+                break;
+            }
+            length = encode_play(buffer, record->card);
+            break;
+        default:
+            length = sprintf(buffer, "(invalid message)\n");
+            break;
+    }
+    buffer[length - 1] = '\0';
+}
+
+/* Print one event of the merged timeline
+ *
+ * @param trace - trace the event came from
+ * @param record - the event
+ * @param start - time of the earliest event in any trace
+ */
+void print_event(const Trace* trace, const TraceRecord* record,
+        uint64_t start) {
+    char label[LABEL_SIZE];
+    if (trace->header.seat == NO_SEAT) {
+        snprintf(label, sizeof(label), "hub(%d)", trace->header.pid);
+    } else {
+        snprintf(label, sizeof(label), "player%d(%d)", trace->header.seat,
+                trace->header.pid);
+    }
+    uint64_t offset = record->time - start;
+    // microseconds since the first event
+    printf("%10llu.%03llu %-16s ", (unsigned long long) (offset / 1000),
+            (unsigned long long) (offset % 1000), label);
+
+    char text[MESSAGE_SIZE];
+    char card[CARD_TEXT_SIZE];
+    switch (record->event) {
+        case TRACE_SENT:
+        case TRACE_RECEIVED:
+            render_message(record, text);
+            if (record->seat == NO_SEAT) {
+                printf("%s %s\n", record->event == TRACE_SENT ? "sent" :
+                        "received", text);
+            } else {
+                printf("%s player %d: %s\n", record->event == TRACE_SENT ?
+                        "sent to" : "received from", record->seat, text);
+            }
+            break;
+        case TRACE_DECISION:
+            render_card(record->card, card);
+            printf("chose card %d (%s)\n", record->number, card);
+            break;
+        case TRACE_ROUND:
+            render_card(record->card, card);
+            printf("round led by %d won by %d with %s\n", record->lead,
+                    record->seat, card);
+            break;
+        case TRACE_CACHE:
+            printf("decision cache %d hits %d misses\n", record->number,
+                    record->extra);
+            break;
+        default:
+            printf("unknown event %d\n", record->event);
+            break;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        quit_merge(USAGE);
+    }
+    int numTraces = argc - 1;
+    Trace* traces = malloc(sizeof(Trace) * numTraces);
+    uint64_t start = UINT64_MAX;
+    for (int i = 0; i < numTraces; i++) {
+        if (read_trace(argv[i + 1], &traces[i])) {
+            quit_merge(FILE_ERROR);
+        }
+        if (traces[i].numRecords && traces[i].records[0].time < start) {
+            start = traces[i].records[0].time;
+        }
+    }
+
+    // each trace is already in time order, so repeatedly take the earliest
+    // head; there are only ever a handful of traces
+    while (true) {
+        int earliest = INVALID;
+        for (int i = 0; i < numTraces; i++) {
+            Trace* trace = &traces[i];
+            if (trace->next < trace->numRecords && (earliest == INVALID
+                    || trace->records[trace->next].time
+                    < traces[earliest].records[traces[earliest].next].time)) {
+                earliest = i;
+            }
+        }
+        if (earliest == INVALID) {
+            break;
+        }
+        Trace* trace = &traces[earliest];
+        print_event(trace, &trace->records[trace->next++], start);
+    }
+
+    for (int i = 0; i < numTraces; i++) {
+        free(traces[i].records);
+    }
+    free(traces);
+    quit_merge(NORMAL);
+}
@@ -0,0 +1,410 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "card.h"
+#include "player.h"
+#include "strategy.h"
+
+#define DEFAULT_PLAYERS 4
+#define DEFAULT_THRESHOLD 4
+#define DEFAULT_GENERATIONS 20
+#define DEFAULT_POPULATION 16
+#define DEFAULT_DEALS 2000
+#define VALIDATION_FACTOR 10 // final comparison uses this many more deals
+#define MAX_PLAYERS 8
+#define MAX_THREADS 256
+#define MAX_CANDIDATES 256
+#define CHUNK_DEALS 32 // deals handed to a thread at a time
+#define Z_95 1.96 // normal quantile for a 95% confidence interval
+
+// How games are played
+typedef struct {
+    int numPlayers;
+    int threshold;
+    int handSize;
+} Setup;
+
+// Results of one candidate, compared game by game with candidate 0
+typedef struct {
+    long games;
+    long wins; // games where bob's seat had the highest (or tied) score
+    long diffSum; // sum of (win - candidate 0's win) over the same games
+    long diffSquares; // sum of squared differences
+} Result;
+
+// Work shared between the threads of one evaluation
+typedef struct {
+    const Setup* setup;
+    const BobParams* candidates;
+    int numCandidates;
+    uint64_t firstDeal; // deal i is shuffled with seed firstDeal + i
+    long numDeals;
+    long nextDeal; // next deal to hand out, claimed atomically
+    Result* results;
+    pthread_mutex_t lock;
+} Evaluation;
+
+/* Print an error message for an exit status and exit with that status
+ * Only NORMAL and USAGE (shared with the players) are used
+ *
+ * @param status - the exit status
+ */
+void quit_tune(enum ExitStatus status) {
+    if (status == USAGE) {
+        fprintf(stderr, "Usage: 2310tune [-j threads] [-p players] "
+                "[-t threshold] [-g generations] [-c candidates] "
+                "[-n deals] [-s seed]\n");
+    }
+    exit(status);
+}
+
+/* Advance an xorshift64* generator
+ *
+ * @param state - generator state, never 0
+ * @return next pseudo random number
+ */
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545f4914f6cdd1dULL;
+}
+
+/* Play one game, bob with the given parameters in one seat and alice in
+ * every other
+ *
+ * @param setup - how games are played
+ * @param params - bob's parameters
+ * @param deck - shuffled deck, dealt in seat order
+ * @param bobSeat - seat bob plays in
+ * @param seats - one game struct per seat, reset here
+ * @return true iff bob's seat had the highest score (ties included)
+ */
+static bool play_once(const Setup* setup, const BobParams* params,
+        const Card* deck, int bobSeat, Game* seats) {
+    int numPlayers = setup->numPlayers;
+    for (int i = 0; i < numPlayers; i++) {
+        Game* seat = &seats[i];
+        reset_game(seat, numPlayers, i, setup->threshold, setup->handSize);
+        memcpy(seat->hand, deck + i * setup->handSize,
+                sizeof(Card) * setup->handSize);
+    }
+
+    int lead = 0;
+    for (int round = 0; round < setup->handSize; round++) {
+        Card played[MAX_PLAYERS];
+        for (int i = 0; i < numPlayers; i++) {
+            seats[i].leadPlayer = lead;
+            seats[i].playerCount = 0;
+        }
+        for (int k = 0; k < numPlayers; k++) {
+            int player = (lead + k) % numPlayers;
+            Game* seat = &seats[player];
+            int index = player == bobSeat ? bob_choose(seat, params) :
+                    alice_choose(seat);
+            played[k] = seat->hand[index];
+            seat->hand[index] = NO_CARD;
+            for (int i = 0; i < numPlayers; i++) {
+                seats[i].turn[player] = played[k];
+                seats[i].playerCount++;
+            }
+        }
+        int winner = (lead + round_winner(played, numPlayers)) % numPlayers;
+        int dPlayed = 0;
+        for (int k = 0; k < numPlayers; k++) {
+            dPlayed += card_suit(played[k]) == PENALTY_SUIT;
+        }
+        for (int i = 0; i < numPlayers; i++) {
+            seats[i].playerPoints[winner]++;
+            seats[i].dWon[winner] += dPlayed;
+        }
+        lead = winner;
+    }
+
+    // scored as the hub does
+    int best = INT32_MIN;
+    int bobScore = 0;
+    for (int i = 0; i < numPlayers; i++) {
+        int points = seats[0].playerPoints[i];
+        int dWon = seats[0].dWon[i];
+        int score = dWon < setup->threshold ? points - dWon : points + dWon;
+        if (score > best) {
+            best = score;
+        }
+        if (i == bobSeat) {
+            bobScore = score;
+        }
+    }
+    return bobScore == best;
+}
+
+/* Thread body: repeatedly claim a chunk of deals and play every candidate
+ * on each of them, with bob in every seat in turn
+ *
+ * @param arg - shared Evaluation
+ * @return NULL
+ */
+static void* evaluate_chunks(void* arg) {
+    Evaluation* evaluation = arg;
+    const Setup* setup = evaluation->setup;
+    Game seats[MAX_PLAYERS];
+    for (int i = 0; i < setup->numPlayers; i++) {
+        seats[i] = setup_game(setup->numPlayers, i, setup->threshold,
+                setup->handSize);
+    }
+    Result* local = calloc(evaluation->numCandidates, sizeof(Result));
+    Card deck[FULL_DECK];
+    bool* wins = malloc(sizeof(bool) * evaluation->numCandidates);
+
+    while (true) {
+        long start = __atomic_fetch_add(&evaluation->nextDeal, CHUNK_DEALS,
+                __ATOMIC_RELAXED);
+        if (start >= evaluation->numDeals) {
+            break;
+        }
+        long end = start + CHUNK_DEALS < evaluation->numDeals ?
+                start + CHUNK_DEALS : evaluation->numDeals;
+        for (long deal = start; deal < end; deal++) {
+            shuffle_deck(evaluation->firstDeal + deal, deck);
+            for (int bobSeat = 0; bobSeat < setup->numPlayers; bobSeat++) {
+                // every candidate sees exactly the same game
+                for (int c = 0; c < evaluation->numCandidates; c++) {
+                    wins[c] = play_once(setup, &evaluation->candidates[c],
+                            deck, bobSeat, seats);
+                    int diff = wins[c] - wins[0];
+                    local[c].games++;
+                    local[c].wins += wins[c];
+                    local[c].diffSum += diff;
+                    local[c].diffSquares += diff * diff;
+                }
+            }
+        }
+    }
+
+    pthread_mutex_lock(&evaluation->lock);
+    for (int c = 0; c < evaluation->numCandidates; c++) {
+        evaluation->results[c].games += local[c].games;
+        evaluation->results[c].wins += local[c].wins;
+        evaluation->results[c].diffSum += local[c].diffSum;
+        evaluation->results[c].diffSquares += local[c].diffSquares;
+    }
+    pthread_mutex_unlock(&evaluation->lock);
+    free(wins);
+    free(local);
+    for (int i = 0; i < setup->numPlayers; i++) {
+        free_game(&seats[i]);
+    }
+    return NULL;
+}
+
+/* Play every candidate on the same deals, spread over threads
+ *
+ * @param setup - how games are played
+ * @param candidates - parameters to evaluate, compared with candidates[0]
+ * @param numCandidates - length of candidates
+ * @param firstDeal - seed of the first deal
+ * @param numDeals - number of deals, each played once per seat
+ * @param numThreads - threads to use
+ * @param results - array of numCandidates results to fill
+ */
+static void evaluate(const Setup* setup, const BobParams* candidates,
+        int numCandidates, uint64_t firstDeal, long numDeals,
+        int numThreads, Result* results) {
+    Evaluation evaluation;
+    evaluation.setup = setup;
+    evaluation.candidates = candidates;
+    evaluation.numCandidates = numCandidates;
+    evaluation.firstDeal = firstDeal;
+    evaluation.numDeals = numDeals;
+    evaluation.nextDeal = 0;
+    evaluation.results = results;
+    memset(results, 0, sizeof(Result) * numCandidates);
+    pthread_mutex_init(&evaluation.lock, NULL);
+
+    pthread_t threads[MAX_THREADS];
+    for (int i = 0; i < numThreads; i++) {
+        pthread_create(&threads[i], NULL, evaluate_chunks, &evaluation);
+    }
+    for (int i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&evaluation.lock);
+}
+
+/* Make a small random change to some parameters: swap two suits in one of
+ * the orders, or move the threshold margin by one
+ *
+ * @param params - parameters to change
+ * @param threshold - largest useful margin
+ * @param state - random generator state
+ */
+static void mutate(BobParams* params, int threshold, uint64_t* state) {
+    Suit* orders[] = {params->leadOrder, params->reachedOrder,
+            params->discardOrder};
+    int choice = next_random(state) % 4;
+    if (choice == 3) {
+        int margin = params->thresholdMargin
+                + (next_random(state) % 2 ? 1 : -1);
+        if (margin >= 0 && margin <= threshold) {
+            params->thresholdMargin = margin;
+        }
+        return;
+    }
+    int i = next_random(state) % NUM_SUITS;
+    int j = next_random(state) % NUM_SUITS;
+    Suit swap = orders[choice][i];
+    orders[choice][i] = orders[choice][j];
+    orders[choice][j] = swap;
+}
+
+/* Sort candidates by their win counts, best first
+ *
+ * @param candidates - parameters
+ * @param results - matching results
+ * @param numCandidates - length of both
+ */
+static void rank_candidates(BobParams* candidates, Result* results,
+        int numCandidates) {
+    for (int i = 1; i < numCandidates; i++) {
+        for (int j = i; j > 0 && results[j].wins > results[j - 1].wins;
+                j--) {
+            BobParams params = candidates[j];
+            candidates[j] = candidates[j - 1];
+            candidates[j - 1] = params;
+            Result result = results[j];
+            results[j] = results[j - 1];
+            results[j - 1] = result;
+        }
+    }
+}
+
+/* Print a win rate with its 95% confidence interval
+ *
+ * @param label - what the rate is for
+ * @param result - games played
+ */
+static void print_rate(const char* label, const Result* result) {
+    double rate = (double) result->wins / result->games;
+    double margin = Z_95 * sqrt(rate * (1 - rate) / result->games);
+    printf("%s=%.4f (95%% CI %.4f-%.4f, %ld games)\n", label, rate,
+            rate - margin, rate + margin, result->games);
+}
+
+/* Parse a numeric option
+ *
+ * @param text - option argument
+ * @param min - smallest value allowed
+ * @param max - largest value allowed
+ * @return value, exiting with USAGE if it is invalid
+ */
+static long parse_option(const char* text, long min, long max) {
+    char* end;
+    long value = strtol(text, &end, 10);
+    if (*end || *text == '\0' || value < min || value > max) {
+        quit_tune(USAGE);
+    }
+    return value;
+}
+
+int main(int argc, char** argv) {
+    int numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    Setup setup = {DEFAULT_PLAYERS, DEFAULT_THRESHOLD, 0};
+    int generations = DEFAULT_GENERATIONS;
+    int numCandidates = DEFAULT_POPULATION;
+    long numDeals = DEFAULT_DEALS;
+    uint64_t seed = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:p:t:g:c:n:s:")) != -1) {
+        switch (opt) {
+            case 'j':
+                numThreads = parse_option(optarg, 1, MAX_THREADS);
+                break;
+            case 'p':
+                setup.numPlayers = parse_option(optarg, 2, MAX_PLAYERS);
+                break;
+            case 't':
+                setup.threshold = parse_option(optarg, 2, NUM_RANKS);
+                break;
+            case 'g':
+                generations = parse_option(optarg, 0, 1000000);
+                break;
+            case 'c':
+                numCandidates = parse_option(optarg, 2, MAX_CANDIDATES);
+                break;
+            case 'n':
+                numDeals = parse_option(optarg, 1, 100000000);
+                break;
+            case 's':
+                seed = parse_option(optarg, 0, INT32_MAX);
+                break;
+            default:
+                quit_tune(USAGE);
+        }
+    }
+    if (optind != argc) {
+        quit_tune(USAGE);
+    }
+    if (numThreads < 1 || numThreads > MAX_THREADS) {
+        numThreads = numThreads < 1 ? 1 : MAX_THREADS;
+    }
+    setup.handSize = NUM_SUITS * NUM_RANKS / setup.numPlayers;
+
+    // start from bob's current parameters and mutations of them
+    uint64_t state = seed * 0x9e3779b97f4a7c15ULL + 1;
+    BobParams candidates[MAX_CANDIDATES];
+    Result results[MAX_CANDIDATES];
+    for (int i = 0; i < numCandidates; i++) {
+        candidates[i] = defaultBobParams;
+        if (i > 0) {
+            mutate(&candidates[i], setup.threshold, &state);
+        }
+    }
+
+    // (mu + lambda) evolution: the best quarter survive each generation
+    // and the rest are replaced by mutations of them, all candidates being
+    // scored on the generation's fresh deals
+    int survivors = numCandidates / 4 > 0 ? numCandidates / 4 : 1;
+    uint64_t firstDeal = seed << 32;
+    char text[BOB_PARAMS_SIZE];
+    for (int generation = 0; generation < generations; generation++) {
+        evaluate(&setup, candidates, numCandidates, firstDeal, numDeals,
+                numThreads, results);
+        firstDeal += numDeals;
+        rank_candidates(candidates, results, numCandidates);
+        format_bob_params(&candidates[0], text);
+        fprintf(stderr, "Generation %d: %s %.4f\n", generation + 1, text,
+                (double) results[0].wins / results[0].games);
+        for (int i = survivors; i < numCandidates; i++) {
+            candidates[i] = candidates[next_random(&state) % survivors];
+            mutate(&candidates[i], setup.threshold, &state);
+            if (next_random(&state) % 2) {
+                mutate(&candidates[i], setup.threshold, &state);
+            }
+        }
+    }
+
+    // compare the winner with the defaults on deals it was never chosen on
+    BobParams finalists[2] = {defaultBobParams, candidates[0]};
+    Result finalResults[2];
+    evaluate(&setup, finalists, 2, firstDeal, numDeals * VALIDATION_FACTOR,
+            numThreads, finalResults);
+    format_bob_params(&finalists[1], text);
+    printf("Best=%s\n", text);
+    print_rate("Win rate", &finalResults[1]);
+    print_rate("Default win rate", &finalResults[0]);
+    // common deals make the paired difference much tighter than either rate
+    long games = finalResults[1].games;
+    double mean = (double) finalResults[1].diffSum / games;
+    double variance = ((double) finalResults[1].diffSquares / games
+            - mean * mean) / (games - 1 > 0 ? games - 1 : 1);
+    double margin = Z_95 * sqrt(variance);
+    printf("Difference=%+.4f (95%% CI %+.4f to %+.4f)\n", mean,
+            mean - margin, mean + margin);
+    quit_tune(NORMAL);
+}
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "card.h"
+#include "spectate.h"
+
+#define POLL_NANOSECONDS 1000000 // wait between checks for new events
+
+// Enum for all spectator exit statuses
+enum ExitStatus {
+    NORMAL = 0,
+    USAGE = 1
+};
+
+/* Print an error message for an exit status and exit with that status
+ *
+ * @param status - the exit status
+ */
+void quit_watch(enum ExitStatus status) {
+    if (status == USAGE) {
+        fprintf(stderr, "Usage: 2310watch name\n");
+    }
+    exit(status);
+}
+
+/* Sleep briefly while waiting for the hub
+ */
+void pause_briefly(void) {
+    struct timespec wait = {0, POLL_NANOSECONDS};
+    nanosleep(&wait, NULL);
+}
+
+/* Try to attach to a hub's ring
+ *
+ * @param name - shared memory name the hub publishes to
+ * @return mapped ring, or NULL if it does not exist (yet)
+ */
+const SpectateRing* attach(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        return NULL;
+    }
+    // the hub may not have sized the object yet
+    struct stat info;
+    if (fstat(fd, &info) || info.st_size < (off_t) sizeof(SpectateRing)) {
+        close(fd);
+        return NULL;
+    }
+    const SpectateRing* ring = mmap(NULL, sizeof(SpectateRing), PROT_READ,
+            MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        return NULL;
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (memcmp(ring->magic, SPECTATE_MAGIC, sizeof(ring->magic))) {
+        munmap((void*) ring, sizeof(SpectateRing));
+        return NULL;
+    }
+    return ring;
+}
+
+/* Print one event
+ *
+ * @param record - the event
+ */
+void print_record(const SpectateRecord* record) {
+    char card[CARD_TEXT_SIZE];
+    printf("game %u ", record->game);
+    switch (record->event) {
+        case SPECTATE_START:
+            printf("start players=%d threshold=%d\n", record->player,
+                    record->number);
+            break;
+        case SPECTATE_PLAY:
+            printf("round %d: player %d played %s\n", record->round + 1,
+                    record->player, card_to_text(record->card, card));
+            break;
+        case SPECTATE_ROUND:
+            printf("round %d: won by player %d with %s (lead %d)\n",
+                    record->round + 1, record->player,
+                    card_to_text(record->card, card), record->number);
+            break;
+        case SPECTATE_SCORE:
+            printf("score player %d: %d\n", record->player, record->number);
+            break;
+        case SPECTATE_END:
+            printf("end status=%d\n", record->number);
+            break;
+        default:
+            printf("unknown event %d\n", record->event);
+            break;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        quit_watch(USAGE);
+    }
+    const SpectateRing* ring;
+    while ((ring = attach(argv[1])) == NULL) {
+        pause_briefly();
+    }
+
+    // start from the oldest event still held
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t next = head > SPECTATE_CAPACITY ? head - SPECTATE_CAPACITY : 0;
+    while (true) {
+        bool closed = __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE);
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (next == head) {
+            if (closed) {
+                break;
+            }
+            fflush(stdout);
+            pause_briefly();
+            continue;
+        }
+        // the hub never waits for us, so we may have been lapped
+        uint64_t oldest = head > SPECTATE_CAPACITY ?
+                head - SPECTATE_CAPACITY : 0;
+        SpectateRecord record;
+        if (next < oldest || spectate_read(ring, next, &record)) {
+            uint64_t skipTo = oldest > next ? oldest : next + 1;
+            fprintf(stderr, "Lapped: missed %llu events\n",
+                    (unsigned long long) (skipTo - next));
+            next = skipTo;
+            continue;
+        }
+        print_record(&record);
+        next++;
+    }
+    fflush(stdout);
+    quit_watch(NORMAL);
+}